@@ -23,6 +23,7 @@
 #include "power_management.h"
 #include "ina228.h"
 #include "tmc5160.h"
+#include "status_report.h"
 
 static const char *TAG = "MAIN";
 
@@ -34,11 +35,14 @@ static const char *TAG = "MAIN";
  */
 static void ina228_task(void *pvParameters)
 {
-    float voltage, current, power;
+    ina228_measurements_t measurements;
     
     while (1) {
-        if (ina228_read_measurements(&voltage, &current, &power) == ESP_OK) {
-            ESP_LOGI(TAG, "Battery: %.2fV, %.2fA, %.2fW", voltage, current, power);
+        if (ina228_read_measurements_detailed(&measurements) == ESP_OK) {
+            float voltage = measurements.bus_voltage_v;
+            float current = measurements.current_a;
+            ESP_LOGI(TAG, "Battery: %.2fV, %.2fA, %.2fW", voltage, current, measurements.power_w);
+            status_report_set_power(&measurements);
             
             // Check for low battery or overcurrent conditions
             if (voltage < 10.5f) {  // Adjust threshold based on battery chemistry
@@ -69,6 +73,7 @@ static void tmc5160_task(void *pvParameters)
         // Read status from all drivers in chain
         if (tmc5160_read_status_all(&status) == ESP_OK) {
             ESP_LOGD(TAG, "TMC5160 Status - Drivers active: %d", status.drivers_active);
+            status_report_set_motors(&status);
             
             // Check for any driver errors
             for (int i = 0; i < TMC5160_MAX_DRIVERS; i++) {
@@ -0,0 +1,125 @@
+/**
+ * @file protocol.h
+ * @brief Robot link wire format
+ *
+ * Generated by shared-cpp/schema/gen_protocol.py from protocol.json. Do not edit.
+ * Structs are packed and little-endian, the same layout as shared-cpp.
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROTO_VERSION              3
+
+#define PROTO_MSG_TYPE_UNDEFINED   0
+#define PROTO_MSG_TYPE_LOG         1  ///< variable length text
+#define PROTO_MSG_TYPE_HEARTBEAT   2
+#define PROTO_MSG_TYPE_COMMAND     3
+#define PROTO_MSG_TYPE_STATUS      4  ///< keyframe/delta telemetry, see status below
+#define PROTO_MSG_TYPE_ESTOP       6
+#define PROTO_MSG_TYPE_BUNDLE      7  ///< several messages in one datagram, see bundle.hpp
+
+#define PROTO_INTEGRITY_NONE                     0
+#define PROTO_INTEGRITY_NONE_TAG_SIZE            0
+#define PROTO_INTEGRITY_CRC32C                   1
+#define PROTO_INTEGRITY_CRC32C_TAG_SIZE          4
+#define PROTO_INTEGRITY_HMAC_SHA256_128          2
+#define PROTO_INTEGRITY_HMAC_SHA256_128_TAG_SIZE 16
+#define PROTO_INTEGRITY_SHA256                   3
+#define PROTO_INTEGRITY_SHA256_TAG_SIZE          32
+
+// Frame header; the C++ definition is hand-written in msg.hpp and checked against this
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t message_type;
+    uint16_t message_length;  ///< payload bytes
+    uint8_t integrity;  ///< Integrity mode of the trailer
+    uint32_t sequence;  ///< per-link datagram counter
+    uint32_t timestamp_us;  ///< sender's monotonic clock
+} proto_message_header_t;
+_Static_assert(sizeof(proto_message_header_t) == 13, "proto_message_header_t size");
+_Static_assert(offsetof(proto_message_header_t, version) == 0, "proto_message_header_t.version offset");
+_Static_assert(offsetof(proto_message_header_t, message_type) == 1, "proto_message_header_t.message_type offset");
+_Static_assert(offsetof(proto_message_header_t, message_length) == 2, "proto_message_header_t.message_length offset");
+_Static_assert(offsetof(proto_message_header_t, integrity) == 4, "proto_message_header_t.integrity offset");
+_Static_assert(offsetof(proto_message_header_t, sequence) == 5, "proto_message_header_t.sequence offset");
+_Static_assert(offsetof(proto_message_header_t, timestamp_us) == 9, "proto_message_header_t.timestamp_us offset");
+
+typedef struct __attribute__((packed)) {
+    uint32_t sequence;  ///< incremented per heartbeat by the sender
+    uint32_t uptime_ms;  ///< sender's uptime
+} proto_heartbeat_payload_t;
+_Static_assert(sizeof(proto_heartbeat_payload_t) == 8, "proto_heartbeat_payload_t size");
+_Static_assert(offsetof(proto_heartbeat_payload_t, sequence) == 0, "proto_heartbeat_payload_t.sequence offset");
+_Static_assert(offsetof(proto_heartbeat_payload_t, uptime_ms) == 4, "proto_heartbeat_payload_t.uptime_ms offset");
+
+typedef struct __attribute__((packed)) {
+    int16_t left_mm_s;  ///< left wheel speed
+    int16_t right_mm_s;  ///< right wheel speed
+} proto_drive_command_payload_t;
+_Static_assert(sizeof(proto_drive_command_payload_t) == 4, "proto_drive_command_payload_t size");
+_Static_assert(offsetof(proto_drive_command_payload_t, left_mm_s) == 0, "proto_drive_command_payload_t.left_mm_s offset");
+_Static_assert(offsetof(proto_drive_command_payload_t, right_mm_s) == 2, "proto_drive_command_payload_t.right_mm_s offset");
+
+typedef struct __attribute__((packed)) {
+    uint8_t engaged;  ///< 1 = stop now, 0 = release
+    uint8_t reason;  ///< sender-defined
+} proto_estop_payload_t;
+_Static_assert(sizeof(proto_estop_payload_t) == 2, "proto_estop_payload_t size");
+_Static_assert(offsetof(proto_estop_payload_t, engaged) == 0, "proto_estop_payload_t.engaged offset");
+_Static_assert(offsetof(proto_estop_payload_t, reason) == 1, "proto_estop_payload_t.reason offset");
+
+// MSG_TYPE_STATUS telemetry, see status.hpp. RobotStatus is flattened
+// depth-first into integer fields, sent as a keyframe (every field as a varint)
+// or a delta (field mask, then zigzag varint differences from the keyframe)
+#define PROTO_MOTOR_FLAG_STST            (1u << 0)
+#define PROTO_MOTOR_FLAG_OLB             (1u << 1)
+#define PROTO_MOTOR_FLAG_OLA             (1u << 2)
+#define PROTO_MOTOR_FLAG_S2GB            (1u << 3)
+#define PROTO_MOTOR_FLAG_S2GA            (1u << 4)
+#define PROTO_MOTOR_FLAG_OTPW            (1u << 5)
+#define PROTO_MOTOR_FLAG_OT              (1u << 6)
+#define PROTO_MOTOR_FLAG_STALLGUARD      (1u << 7)
+#define PROTO_MOTOR_FLAG_STEALTH_ACTIVE  (1u << 8)
+
+#define PROTO_STATUS_MOTOR_COUNT   4
+#define PROTO_STATUS_KEYFRAME      1
+#define PROTO_STATUS_DELTA         2
+#define PROTO_STATUS_FIELD_COUNT   23
+
+// One tmc5160_driver_status_t, booleans folded into flags
+typedef struct {
+    uint16_t flags;  ///< motor_flags bits
+    uint16_t stallguard_result;
+    uint8_t cs_actual;
+    uint8_t error_flags;
+} proto_motor_status_t;
+
+// ina228_measurements_t in fixed point, so small changes are small deltas
+typedef struct {
+    int32_t bus_voltage_mv;
+    int32_t shunt_voltage_uv;
+    int32_t current_ma;
+    int32_t power_mw;
+    int32_t die_temperature_cdeg;  ///< hundredths of a degree Celsius
+} proto_power_status_t;
+
+typedef struct {
+    uint8_t drivers_active;
+    uint32_t communication_errors;
+    proto_motor_status_t motors[PROTO_STATUS_MOTOR_COUNT];
+    proto_power_status_t power;
+} proto_robot_status_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROTOCOL_H
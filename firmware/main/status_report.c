@@ -0,0 +1,74 @@
+/**
+ * @file status_report.c
+ * @brief Robot status snapshot implementation
+ */
+
+#include "status_report.h"
+#include "freertos/FreeRTOS.h"
+
+#include <math.h>
+
+static proto_robot_status_t g_status = {0};
+static portMUX_TYPE g_status_lock = portMUX_INITIALIZER_UNLOCKED;
+
+_Static_assert(PROTO_STATUS_MOTOR_COUNT == TMC5160_MAX_DRIVERS, "status carries one block per driver");
+
+/**
+ * @brief Fold a driver status into the wire representation
+ */
+static proto_motor_status_t motor_from_driver(const tmc5160_driver_status_t *driver)
+{
+    proto_motor_status_t motor = {0};
+    motor.flags = (driver->stst ? PROTO_MOTOR_FLAG_STST : 0) |
+                  (driver->olb ? PROTO_MOTOR_FLAG_OLB : 0) |
+                  (driver->ola ? PROTO_MOTOR_FLAG_OLA : 0) |
+                  (driver->s2gb ? PROTO_MOTOR_FLAG_S2GB : 0) |
+                  (driver->s2ga ? PROTO_MOTOR_FLAG_S2GA : 0) |
+                  (driver->otpw ? PROTO_MOTOR_FLAG_OTPW : 0) |
+                  (driver->ot ? PROTO_MOTOR_FLAG_OT : 0) |
+                  (driver->stallguard ? PROTO_MOTOR_FLAG_STALLGUARD : 0) |
+                  (driver->stealth_active ? PROTO_MOTOR_FLAG_STEALTH_ACTIVE : 0);
+    motor.stallguard_result = driver->stallguard_result;
+    motor.cs_actual = driver->cs_actual;
+    motor.error_flags = driver->error_flags;
+    return motor;
+}
+
+void status_report_set_motors(const tmc5160_status_t *status)
+{
+    proto_motor_status_t motors[PROTO_STATUS_MOTOR_COUNT];
+    for (int i = 0; i < PROTO_STATUS_MOTOR_COUNT; i++) {
+        motors[i] = motor_from_driver(&status->driver_status[i]);
+    }
+
+    taskENTER_CRITICAL(&g_status_lock);
+    g_status.drivers_active = status->drivers_active;
+    g_status.communication_errors = status->communication_errors;
+    for (int i = 0; i < PROTO_STATUS_MOTOR_COUNT; i++) {
+        g_status.motors[i] = motors[i];
+    }
+    taskEXIT_CRITICAL(&g_status_lock);
+}
+
+void status_report_set_power(const ina228_measurements_t *measurements)
+{
+    // Fixed point, so unchanged readings compress to nothing on the wire
+    proto_power_status_t power = {
+        .bus_voltage_mv = (int32_t)lroundf(measurements->bus_voltage_v * 1000.0f),
+        .shunt_voltage_uv = (int32_t)lroundf(measurements->shunt_voltage_mv * 1000.0f),
+        .current_ma = (int32_t)lroundf(measurements->current_a * 1000.0f),
+        .power_mw = (int32_t)lroundf(measurements->power_w * 1000.0f),
+        .die_temperature_cdeg = (int32_t)lroundf(measurements->die_temperature_c * 100.0f),
+    };
+
+    taskENTER_CRITICAL(&g_status_lock);
+    g_status.power = power;
+    taskEXIT_CRITICAL(&g_status_lock);
+}
+
+void status_report_get(proto_robot_status_t *status)
+{
+    taskENTER_CRITICAL(&g_status_lock);
+    *status = g_status;
+    taskEXIT_CRITICAL(&g_status_lock);
+}
@@ -0,0 +1,48 @@
+/**
+ * @file status_report.h
+ * @brief Robot status snapshot in the shared wire format
+ * 
+ * Collects the latest TMC5160 and INA228 readings into a
+ * proto_robot_status_t (protocol.h, generated from
+ * shared-cpp/schema/protocol.json), the struct MSG_TYPE_STATUS telemetry
+ * carries. The monitoring tasks update it; the communication system reads
+ * a consistent copy.
+ */
+
+#ifndef STATUS_REPORT_H
+#define STATUS_REPORT_H
+
+#include "ina228.h"
+#include "protocol.h"
+#include "tmc5160.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Record the status of all drivers in the chain
+ * 
+ * @param status Status read by tmc5160_read_status_all()
+ */
+void status_report_set_motors(const tmc5160_status_t *status);
+
+/**
+ * @brief Record a power measurement
+ * 
+ * @param measurements Measurements read by ina228_read_measurements_detailed()
+ */
+void status_report_set_power(const ina228_measurements_t *measurements);
+
+/**
+ * @brief Copy the latest snapshot
+ * 
+ * @param status Pointer to store the snapshot
+ */
+void status_report_get(proto_robot_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATUS_REPORT_H
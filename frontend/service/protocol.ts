@@ -0,0 +1,284 @@
+// Generated by shared-cpp/schema/gen_protocol.py from protocol.json. Do not edit.
+//
+// Codecs for binary robot frames forwarded over DataChannels. Fields are
+// little-endian at fixed offsets, matching the packed C and C++ structs.
+
+export const PROTOCOL_VERSION = 3;
+
+export enum MessageType {
+  UNDEFINED = 0,
+  LOG = 1, // variable length text
+  HEARTBEAT = 2,
+  COMMAND = 3,
+  STATUS = 4, // keyframe/delta telemetry, see status below
+  ESTOP = 6,
+  BUNDLE = 7, // several messages in one datagram, see bundle.hpp
+};
+
+export enum Integrity {
+  NONE = 0,
+  CRC32C = 1,
+  HMAC_SHA256_128 = 2,
+  SHA256 = 3,
+};
+
+export const INTEGRITY_TAG_SIZE: Record<Integrity, number> = {
+  [Integrity.NONE]: 0,
+  [Integrity.CRC32C]: 4,
+  [Integrity.HMAC_SHA256_128]: 16,
+  [Integrity.SHA256]: 32,
+};
+
+// Frame header; the C++ definition is hand-written in msg.hpp and checked against this
+export type MessageHeader = {
+  version: number;
+  message_type: number;
+  message_length: number; // payload bytes
+  integrity: number; // Integrity mode of the trailer
+  sequence: number; // per-link datagram counter
+  timestamp_us: number; // sender's monotonic clock
+}
+
+export const MESSAGE_HEADER_SIZE = 13;
+
+export function readMessageHeader(view: DataView, offset = 0): MessageHeader {
+  return {
+    version: view.getUint8(offset + 0),
+    message_type: view.getUint8(offset + 1),
+    message_length: view.getUint16(offset + 2, true),
+    integrity: view.getUint8(offset + 4),
+    sequence: view.getUint32(offset + 5, true),
+    timestamp_us: view.getUint32(offset + 9, true),
+  };
+}
+
+export function writeMessageHeader(view: DataView, value: MessageHeader, offset = 0): void {
+  view.setUint8(offset + 0, value.version);
+  view.setUint8(offset + 1, value.message_type);
+  view.setUint16(offset + 2, value.message_length, true);
+  view.setUint8(offset + 4, value.integrity);
+  view.setUint32(offset + 5, value.sequence, true);
+  view.setUint32(offset + 9, value.timestamp_us, true);
+}
+
+export type HeartbeatPayload = {
+  sequence: number; // incremented per heartbeat by the sender
+  uptime_ms: number; // sender's uptime
+}
+
+export const HEARTBEAT_PAYLOAD_SIZE = 8;
+
+export function readHeartbeatPayload(view: DataView, offset = 0): HeartbeatPayload {
+  return {
+    sequence: view.getUint32(offset + 0, true),
+    uptime_ms: view.getUint32(offset + 4, true),
+  };
+}
+
+export function writeHeartbeatPayload(view: DataView, value: HeartbeatPayload, offset = 0): void {
+  view.setUint32(offset + 0, value.sequence, true);
+  view.setUint32(offset + 4, value.uptime_ms, true);
+}
+
+export type DriveCommandPayload = {
+  left_mm_s: number; // left wheel speed
+  right_mm_s: number; // right wheel speed
+}
+
+export const DRIVE_COMMAND_PAYLOAD_SIZE = 4;
+
+export function readDriveCommandPayload(view: DataView, offset = 0): DriveCommandPayload {
+  return {
+    left_mm_s: view.getInt16(offset + 0, true),
+    right_mm_s: view.getInt16(offset + 2, true),
+  };
+}
+
+export function writeDriveCommandPayload(view: DataView, value: DriveCommandPayload, offset = 0): void {
+  view.setInt16(offset + 0, value.left_mm_s, true);
+  view.setInt16(offset + 2, value.right_mm_s, true);
+}
+
+export type EstopPayload = {
+  engaged: number; // 1 = stop now, 0 = release
+  reason: number; // sender-defined
+}
+
+export const ESTOP_PAYLOAD_SIZE = 2;
+
+export function readEstopPayload(view: DataView, offset = 0): EstopPayload {
+  return {
+    engaged: view.getUint8(offset + 0),
+    reason: view.getUint8(offset + 1),
+  };
+}
+
+export function writeEstopPayload(view: DataView, value: EstopPayload, offset = 0): void {
+  view.setUint8(offset + 0, value.engaged);
+  view.setUint8(offset + 1, value.reason);
+}
+
+// MSG_TYPE_STATUS telemetry, see status.hpp. RobotStatus is flattened
+// depth-first into integer fields, sent as a keyframe (every field as a varint)
+// or a delta (field mask, then zigzag varint differences from the keyframe)
+export const MotorFlag = {
+  STST: 1 << 0,
+  OLB: 1 << 1,
+  OLA: 1 << 2,
+  S2GB: 1 << 3,
+  S2GA: 1 << 4,
+  OTPW: 1 << 5,
+  OT: 1 << 6,
+  STALLGUARD: 1 << 7,
+  STEALTH_ACTIVE: 1 << 8,
+} as const;
+
+export const STATUS_MOTOR_COUNT = 4;
+export const STATUS_KEYFRAME = 1;
+export const STATUS_DELTA = 2;
+export const STATUS_FIELD_COUNT = 23;
+export const STATUS_MASK_BYTES = (STATUS_FIELD_COUNT + 7) >> 3;
+
+export enum StatusError {
+  NONE = 0,
+  TRUNCATED = 1, // ends inside the mask or a varint
+  BAD_KIND = 2, // neither keyframe nor delta
+  NO_KEYFRAME = 3, // delta against a keyframe we never received
+  MALFORMED = 4, // varint too long or trailing bytes
+};
+
+// One tmc5160_driver_status_t, booleans folded into flags
+export type MotorStatus = {
+  flags: number; // motor_flags bits
+  stallguard_result: number;
+  cs_actual: number;
+  error_flags: number;
+}
+
+// ina228_measurements_t in fixed point, so small changes are small deltas
+export type PowerStatus = {
+  bus_voltage_mv: number;
+  shunt_voltage_uv: number;
+  current_ma: number;
+  power_mw: number;
+  die_temperature_cdeg: number; // hundredths of a degree Celsius
+}
+
+export type RobotStatus = {
+  drivers_active: number;
+  communication_errors: number;
+  motors: MotorStatus[];
+  power: PowerStatus;
+}
+
+function unflattenStatus(fields: Uint32Array): RobotStatus {
+  let i = 0;
+  const next = () => fields[i++];
+  return {
+    drivers_active: next() & 0xff,
+    communication_errors: next(),
+    motors: Array.from({ length: STATUS_MOTOR_COUNT }, () => ({
+      flags: next() & 0xffff,
+      stallguard_result: next() & 0xffff,
+      cs_actual: next() & 0xff,
+      error_flags: next() & 0xff,
+    })),
+    power: {
+      bus_voltage_mv: next() | 0,
+      shunt_voltage_uv: next() | 0,
+      current_ma: next() | 0,
+      power_mw: next() | 0,
+      die_temperature_cdeg: next() | 0,
+    },
+  };
+}
+
+// Receiver side of the keyframe/delta STATUS encoding
+export class StatusDecoder {
+  private key = new Uint32Array(STATUS_FIELD_COUNT);
+  private keyId = -1;
+
+  /**
+   * @param payload MSG_TYPE_STATUS payload
+   * @returns the status, or null and why not
+   */
+  decode(payload: Uint8Array): { error: StatusError; status: RobotStatus | null } {
+    if (payload.length < 2) {
+      return { error: StatusError.TRUNCATED, status: null };
+    }
+    const kind = payload[0];
+    const keyId = payload[1];
+    const fields = new Uint32Array(STATUS_FIELD_COUNT);
+    let p = 2;
+
+    let error = StatusError.NONE;
+    const fail = (reason: StatusError) => ({ error: reason, status: null });
+
+    // LEB128, at most 5 bytes for 32 bits; -1 with error set on failure
+    const varint = (): number => {
+      let value = 0;
+      for (let i = 0; i < 5; ++i) {
+        if (p >= payload.length) {
+          error = StatusError.TRUNCATED;
+          return -1;
+        }
+        const byte = payload[p++];
+        value = (value | ((byte & 0x7f) << (7 * i))) >>> 0;
+        if (!(byte & 0x80)) {
+          return value;
+        }
+      }
+      error = StatusError.MALFORMED;
+      return -1;
+    };
+
+    if (kind === STATUS_KEYFRAME) {
+      for (let i = 0; i < STATUS_FIELD_COUNT; ++i) {
+        const value = varint();
+        if (value < 0) {
+          return fail(error);
+        }
+        fields[i] = value;
+      }
+    } else if (kind === STATUS_DELTA) {
+      if (keyId !== this.keyId) {
+        return fail(StatusError.NO_KEYFRAME);
+      }
+      if (payload.length - p < STATUS_MASK_BYTES) {
+        return fail(StatusError.TRUNCATED);
+      }
+      const mask = p;
+      p += STATUS_MASK_BYTES;
+      for (let i = 0; i < STATUS_FIELD_COUNT; ++i) {
+        fields[i] = this.key[i];
+        if (!(payload[mask + (i >> 3)] & (1 << (i & 7)))) {
+          continue;
+        }
+        const delta = varint();
+        if (delta < 0) {
+          return fail(error);
+        }
+        // Zigzag back to a signed difference; the store wraps mod 2^32
+        fields[i] = this.key[i] + ((delta >>> 1) ^ -(delta & 1));
+      }
+    } else {
+      return fail(StatusError.BAD_KIND);
+    }
+
+    if (p !== payload.length) {
+      return fail(StatusError.MALFORMED);
+    }
+    if (kind === STATUS_KEYFRAME) {
+      this.key.set(fields);
+      this.keyId = keyId;
+    }
+    return { error: StatusError.NONE, status: unflattenStatus(fields) };
+  }
+}
+
+// Payload size of each fixed-size message type
+export const PAYLOAD_SIZE: Partial<Record<MessageType, number>> = {
+  [MessageType.HEARTBEAT]: HEARTBEAT_PAYLOAD_SIZE,
+  [MessageType.COMMAND]: DRIVE_COMMAND_PAYLOAD_SIZE,
+  [MessageType.ESTOP]: ESTOP_PAYLOAD_SIZE,
+};
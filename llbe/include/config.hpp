@@ -3,6 +3,8 @@
 
 #include <string>
 #include <memory>
+#include <map>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 /**
@@ -24,6 +26,33 @@ public:
     std::string file = "llbe.log";
     bool console_output = true;
     bool enable_file_logging = true;
+    bool async = false;
+    int async_queue_size = 8192;
+    std::string async_overflow = "drop"; // "drop" or "block"
+    // Per-category level overrides, e.g. { "trunk": "debug" }
+    std::map<std::string, std::string> categories = {};
+    std::string timestamp = "local"; // "local", "utc", "monotonic" or "epoch_us"
+    std::string format = "text"; // "text", "binary" (decode with logdecode) or "json" (JSON lines)
+    double rate_limit_per_sec = 0.0; // per call site, 0 (default) disables; ERROR and above are exempt
+    int rate_limit_burst = 100; // used once rate_limit_per_sec is set
+    bool collapse_duplicates = false; // "last message repeated N times", opt-in
+    int rotate_size_mb = 0; // rotate the log file at this size, 0 (default) = never
+    int rotate_interval_hours = 0; // rotate the log file at this age, 0 (default) = never
+    int retain_files = 10; // rotated segments to keep, 0 = all
+    bool compress_rotated = false; // gzip rotated segments (needs a zlib build)
+    bool preallocate = false; // fallocate each segment to rotate_size_mb
+    std::string flight_recorder = ""; // crash-surviving ring file, "" disables (config.json ships "llbe.flight")
+    int flight_recorder_records = 8192;
+    std::string flight_recorder_level = "debug"; // recorded regardless of "level"
+    int flush_bytes = 4096; // async writer: write once this much is batched
+    int flush_interval_ms = 5; // ... or once the oldest line is this old
+    bool io_uring = false; // submit log file writes through io_uring (Linux)
+    bool sync_critical = false; // fdatasync() CRITICAL lines before returning
+    // Multicast groups ("address[:port]") that receive log lines for loglistener,
+    // e.g. "239.255.0.2:12345"; off by default, lines go to the whole LAN
+    std::vector<std::string> multicast = {};
+    int multicast_ttl = 1; // 1 keeps log packets on the local network
+    int multicast_queue = 1024; // lines queued for sending, dropped beyond this
   };
 
   struct WebRTCConfig
@@ -0,0 +1,116 @@
+#ifndef LLBE_INCLUDE_FLIGHT_RECORDER_HPP
+#define LLBE_INCLUDE_FLIGHT_RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace llbe
+{
+  /**
+   * Crash-surviving ring of recent log records.
+   *
+   * The ring lives in a MAP_SHARED mapping of a file, so whatever was written
+   * before a crash or SIGKILL is still in the page cache and ends up on disk.
+   * Writers claim a slot with one fetch_add and never block; the oldest
+   * records are overwritten. Dump a recorder file with the flightdump tool.
+   *
+   * File layout (native endianness, the file is read back on the same host):
+   *   Header, then slot_count fixed-size Slots
+   */
+  class FlightRecorder
+  {
+  public:
+    static constexpr char MAGIC[8] = {'L', 'L', 'B', 'E', 'F', 'L', 'T', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t SLOT_SIZE = 256;
+
+    struct Header
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t slot_size;
+      uint32_t slot_count;
+      uint8_t timestamp_mode; // llbe::TimestampFormatter::Mode of the stamps
+      uint8_t reserved[11];
+      std::atomic<uint64_t> next; // sequence number of the next record
+      uint8_t padding[24];
+    };
+
+    struct Slot
+    {
+      std::atomic<uint64_t> seq; // record sequence + 1, 0 while being written
+      int64_t time;
+      uint32_t thread;
+      uint8_t level;
+      uint8_t category;
+      uint16_t length;
+      char text[SLOT_SIZE - 24];
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(sizeof(Slot) == SLOT_SIZE);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+    /**
+     * A record read back from a recorder file
+     */
+    struct Entry
+    {
+      uint64_t seq;
+      int64_t time;
+      uint32_t thread;
+      uint8_t level;
+      uint8_t category;
+      std::string text;
+    };
+
+    FlightRecorder() = default;
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    /**
+     * Create the recorder file and map it. An existing file is kept as
+     * "<path>.prev" so a restart does not wipe the previous crash.
+     * @param path recorder file
+     * @param slots number of records to keep
+     * @param timestamp_mode mode used for the stamps passed to record()
+     * @return false on error
+     */
+    bool open(const std::string &path, size_t slots, uint8_t timestamp_mode);
+
+    /**
+     * Append a record, overwriting the oldest. Lock-free; text longer than
+     * a slot is truncated.
+     * @param time timestamp in ns
+     * @param level log level
+     * @param category log category
+     * @param text message
+     */
+    void record(int64_t time, uint8_t level, uint8_t category, std::string_view text);
+
+    inline bool isOpen() const { return header_ != nullptr; }
+
+    /**
+     * Read the records of a recorder file, oldest first
+     * @param path recorder file
+     * @param header receives the file header fields (next is not loaded)
+     * @param entries receives the records
+     * @return false if the file is missing or not a recorder file
+     */
+    static bool load(const std::string &path, Header &header, std::vector<Entry> &entries);
+
+  private:
+    Header *header_ = nullptr;
+    Slot *slots_ = nullptr;
+    size_t slot_count_ = 0;
+    size_t mapped_size_ = 0;
+  };
+}
+
+#endif // LLBE_INCLUDE_FLIGHT_RECORDER_HPP
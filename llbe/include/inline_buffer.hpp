@@ -0,0 +1,134 @@
+#ifndef LLBE_INCLUDE_INLINE_BUFFER_HPP
+#define LLBE_INCLUDE_INLINE_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace llbe
+{
+  /**
+   * Byte buffer that keeps up to N bytes inline and only moves to the heap
+   * once it outgrows them. Used for log record payloads so that typical
+   * lines are queued and moved between threads without allocating.
+   *
+   * Copies and moves only touch the bytes in use.
+   */
+  template <size_t N>
+  class InlineBuffer
+  {
+  public:
+    InlineBuffer() = default;
+
+    InlineBuffer(std::string_view text) { append(text.data(), text.size()); }
+    InlineBuffer(const std::string &text) : InlineBuffer(std::string_view(text)) {}
+    InlineBuffer(const char *text) : InlineBuffer(std::string_view(text)) {}
+
+    InlineBuffer(const InlineBuffer &other) { *this = other; }
+    InlineBuffer(InlineBuffer &&other) noexcept { *this = std::move(other); }
+
+    InlineBuffer &operator=(const InlineBuffer &other)
+    {
+      if (this != &other)
+      {
+        clear();
+        append(other.data(), other.size());
+      }
+      return *this;
+    }
+
+    InlineBuffer &operator=(InlineBuffer &&other) noexcept
+    {
+      if (this != &other)
+      {
+        on_heap_ = other.on_heap_;
+        size_ = other.size_;
+        if (on_heap_)
+        {
+          heap_.swap(other.heap_);
+        }
+        else
+        {
+          std::memcpy(inline_, other.inline_, size_);
+        }
+        other.clear();
+      }
+      return *this;
+    }
+
+    inline const char *data() const { return on_heap_ ? heap_.data() : inline_; }
+    inline size_t size() const { return size_; }
+    inline bool empty() const { return size_ == 0; }
+
+    /**
+     * @return true once the contents no longer fit inline
+     */
+    inline bool onHeap() const { return on_heap_; }
+
+    inline operator std::string_view() const { return std::string_view(data(), size_); }
+
+    inline bool operator==(const InlineBuffer &other) const
+    {
+      return std::string_view(*this) == std::string_view(other);
+    }
+
+    /**
+     * Empty the buffer. Heap capacity is kept for reuse.
+     */
+    inline void clear()
+    {
+      heap_.clear();
+      on_heap_ = false;
+      size_ = 0;
+    }
+
+    inline void push_back(char c)
+    {
+      if (!on_heap_ && size_ < N)
+      {
+        inline_[size_++] = c;
+        return;
+      }
+      appendHeap(&c, 1);
+    }
+
+    inline void append(const char *p, size_t n)
+    {
+      if (!on_heap_ && n <= N - size_)
+      {
+        std::memcpy(inline_ + size_, p, n);
+        size_ += n;
+        return;
+      }
+      appendHeap(p, n);
+    }
+
+    inline InlineBuffer &operator+=(std::string_view text)
+    {
+      append(text.data(), text.size());
+      return *this;
+    }
+
+  private:
+    void appendHeap(const char *p, size_t n)
+    {
+      if (!on_heap_)
+      {
+        heap_.reserve(size_ + n);
+        heap_.assign(inline_, size_);
+        on_heap_ = true;
+      }
+      heap_.append(p, n);
+      size_ += n;
+    }
+
+    size_t size_ = 0;
+    bool on_heap_ = false;
+    char inline_[N];
+    std::string heap_; // holds all the bytes once on_heap_ is set
+  };
+}
+
+#endif // LLBE_INCLUDE_INLINE_BUFFER_HPP
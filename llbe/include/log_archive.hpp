@@ -0,0 +1,108 @@
+#ifndef LLBE_INCLUDE_LOG_ARCHIVE_HPP
+#define LLBE_INCLUDE_LOG_ARCHIVE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace llbe
+{
+  /**
+   * Background handling of closed log segments.
+   *
+   * Rotated segments are handed over with submit(); a low-priority worker
+   * gzips them (when built with zlib) and then deletes the oldest archives
+   * so that at most max_files are kept next to the active log.
+   */
+  class LogArchiver
+  {
+  public:
+    /**
+     * @param log_path path of the active log file; archives are named
+     *   "<log_path>.<UTC stamp>[.gz]"
+     * @param max_files archives to keep, 0 keeps all
+     * @param compress gzip archived segments
+     */
+    LogArchiver(std::string log_path, size_t max_files, bool compress);
+
+    /**
+     * Finishes pending segments before returning
+     */
+    ~LogArchiver();
+
+    LogArchiver(const LogArchiver &) = delete;
+    LogArchiver &operator=(const LogArchiver &) = delete;
+
+    /**
+     * Pick an unused archive name for a segment rotated now
+     * @return path to rename the active log to
+     */
+    std::string nextSegmentPath() const;
+
+    /**
+     * nextSegmentPath() for a log without an archiver
+     * @param log_path path of the active log file
+     * @return unused "<log_path>.<UTC stamp>" path
+     */
+    static std::string nextSegmentPath(const std::string &log_path);
+
+    /**
+     * Queue a closed segment for compression and retention
+     * @param segment_path path returned by nextSegmentPath()
+     */
+    void submit(std::string segment_path);
+
+    /**
+     * Delete the oldest archives beyond max_files
+     */
+    void enforceRetention();
+
+    /**
+     * @return true if built with zlib, i.e. compressFile() can work
+     */
+    static bool compressionAvailable();
+
+    /**
+     * gzip a file
+     * @param src file to compress
+     * @param dst output path
+     * @return false on error, or if built without zlib
+     */
+    static bool compressFile(const std::string &src, const std::string &dst);
+
+    /**
+     * Reserve disk blocks for a file without changing its size, so appends
+     * do not allocate extents. Filesystems without support are ignored.
+     * @param path file to preallocate
+     * @param bytes bytes to reserve from offset 0
+     * @return true if the space was reserved
+     */
+    static bool preallocate(const std::string &path, uint64_t bytes);
+
+    /**
+     * Release blocks reserved past the end of a closed file
+     * @param path file to trim
+     * @return false on error
+     */
+    static bool releasePreallocated(const std::string &path);
+
+  private:
+    void workerLoop();
+
+    std::string log_path_;
+    size_t max_files_;
+    bool compress_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> pending_;
+    bool stop_ = false;
+    std::thread worker_;
+  };
+}
+
+#endif // LLBE_INCLUDE_LOG_ARCHIVE_HPP
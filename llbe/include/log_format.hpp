@@ -0,0 +1,240 @@
+#ifndef LLBE_INCLUDE_LOG_FORMAT_HPP
+#define LLBE_INCLUDE_LOG_FORMAT_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Deferred log formatting.
+ *
+ * Call sites register their format string once and get a small id back;
+ * arguments are captured as tagged raw values. The text is only rendered
+ * when (and where) it is needed: on the async writer thread, or offline by
+ * the logdecode tool when the file is written in binary mode.
+ *
+ * Format strings use "{}" placeholders, "{{" and "}}" for literal braces.
+ * Arguments are encoded into any byte buffer with push_back(char) and
+ * append(const char *, size_t): std::string, or llbe::InlineBuffer to stay
+ * off the heap.
+ */
+namespace llbe::logfmt
+{
+  enum class ArgType : uint8_t
+  {
+    I64 = 1,
+    U64 = 2,
+    F64 = 3,
+    STR = 4,
+    BOOL = 5,
+    CHAR = 6,
+    KEY = 7 // u8 length, key bytes; the field's value follows as its own argument
+  };
+
+  // Binary log file layout (all integers little-endian):
+  //   file:    MAGIC, then any sequence of entries
+  //   session: TAG_SESSION u8 version, u8 timestamp mode
+  //   format:  TAG_FORMAT  u32 id, u16 length, format bytes
+  //   record:  TAG_RECORD  u8 level, u8 category, i64 stamp ns, u32 format id,
+  //                        u32 length, argument bytes (raw text if id == 0)
+  inline constexpr char MAGIC[8] = {'L', 'L', 'B', 'E', 'L', 'O', 'G', '\0'};
+  inline constexpr uint8_t BINARY_VERSION = 1;
+  inline constexpr uint8_t TAG_FORMAT = 1;
+  inline constexpr uint8_t TAG_RECORD = 2;
+  inline constexpr uint8_t TAG_SESSION = 3;
+
+  // Format id 0 means "payload is already text"
+  inline constexpr uint32_t RAW_TEXT = 0;
+  inline constexpr uint32_t MAX_FORMATS = 4096;
+
+  /**
+   * Register a format string. The pointer must stay valid for the lifetime
+   * of the process (string literals). Thread-safe.
+   * @param fmt format string
+   * @return id > 0, or RAW_TEXT if the registry is full
+   */
+  uint32_t registerFormat(const char *fmt);
+
+  /**
+   * Look up a registered format string. Lock-free.
+   * @param id id from registerFormat
+   * @return format string, nullptr if unknown
+   */
+  const char *formatString(uint32_t id);
+
+  /**
+   * Render a format string with encoded arguments. Key/value fields left
+   * after the placeholders are appended as " key=value".
+   * @param out string to append to
+   * @param fmt format string
+   * @param args encoded arguments
+   * @param len size of args in bytes
+   */
+  void render(std::string &out, std::string_view fmt, const uint8_t *args, size_t len);
+
+  /**
+   * Render only the message part of a format string, without the fields
+   * @param out string to append to
+   * @param fmt format string
+   * @param args encoded arguments
+   * @param len size of args in bytes
+   * @return offset of the first key/value field in args (len if none)
+   */
+  size_t renderMessage(std::string &out, std::string_view fmt, const uint8_t *args, size_t len);
+
+  /**
+   * Append text as a quoted JSON string, escaping as needed
+   * @param out string to append to
+   * @param text raw text
+   */
+  void appendJsonString(std::string &out, std::string_view text);
+
+  /**
+   * Append key/value fields as JSON object members (",\"key\":value").
+   * Strings are escaped, numbers and bools are written bare.
+   * @param out string to append to
+   * @param args encoded arguments
+   * @param len size of args in bytes
+   * @param offset offset of the first field, from renderMessage()
+   * @return number of members written
+   */
+  size_t renderJsonFields(std::string &out, const uint8_t *args, size_t len, size_t offset);
+
+  /**
+   * Key/value field, appended to the line as " key=value" after the
+   * formatted message. Create with llbe::kv() and pass after the
+   * positional arguments: LOG_INFOF("peer state", llbe::kv("session", id)).
+   */
+  template <typename T>
+  struct Field
+  {
+    std::string_view key;
+    const T &value;
+  };
+
+  /**
+   * @param key field name (up to 255 bytes)
+   * @param value field value, any type accepted by the LOG_*F macros
+   * @return field for a LOG_*F argument list
+   */
+  template <typename T>
+  inline Field<T> kv(std::string_view key, const T &value)
+  {
+    return Field<T>{key, value};
+  }
+
+  template <typename T, typename Buf>
+  inline void putLE(Buf &buf, T value)
+  {
+    static_assert(std::is_integral_v<T>);
+    using U = std::make_unsigned_t<T>;
+    U v = static_cast<U>(value);
+    for (size_t i = 0; i < sizeof(T); ++i)
+      buf.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  }
+
+  template <typename T>
+  inline T getLE(const uint8_t *p)
+  {
+    static_assert(std::is_integral_v<T>);
+    using U = std::make_unsigned_t<T>;
+    U v = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+      v |= static_cast<U>(static_cast<U>(p[i]) << (8 * i));
+    return static_cast<T>(v);
+  }
+
+  template <typename Buf>
+  inline void encodeArg(Buf &buf, bool value)
+  {
+    buf.push_back(static_cast<char>(ArgType::BOOL));
+    buf.push_back(value ? 1 : 0);
+  }
+
+  template <typename Buf>
+  inline void encodeArg(Buf &buf, char value)
+  {
+    buf.push_back(static_cast<char>(ArgType::CHAR));
+    buf.push_back(value);
+  }
+
+  template <typename Buf, std::signed_integral T>
+  inline void encodeArg(Buf &buf, T value)
+  {
+    buf.push_back(static_cast<char>(ArgType::I64));
+    putLE<int64_t>(buf, static_cast<int64_t>(value));
+  }
+
+  template <typename Buf, std::unsigned_integral T>
+    requires(!std::same_as<T, bool>)
+  inline void encodeArg(Buf &buf, T value)
+  {
+    buf.push_back(static_cast<char>(ArgType::U64));
+    putLE<uint64_t>(buf, static_cast<uint64_t>(value));
+  }
+
+  template <typename Buf, std::floating_point T>
+  inline void encodeArg(Buf &buf, T value)
+  {
+    double d = static_cast<double>(value);
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    buf.push_back(static_cast<char>(ArgType::F64));
+    putLE<uint64_t>(buf, bits);
+  }
+
+  template <typename Buf>
+  inline void encodeArg(Buf &buf, std::string_view value)
+  {
+    buf.push_back(static_cast<char>(ArgType::STR));
+    putLE<uint32_t>(buf, static_cast<uint32_t>(value.size()));
+    buf.append(value.data(), value.size());
+  }
+
+  template <typename Buf>
+  inline void encodeArg(Buf &buf, const std::string &value)
+  {
+    encodeArg(buf, std::string_view(value));
+  }
+
+  template <typename Buf>
+  inline void encodeArg(Buf &buf, const char *value)
+  {
+    encodeArg(buf, std::string_view(value ? value : "(null)"));
+  }
+
+  template <typename Buf, typename T>
+    requires std::is_enum_v<T>
+  inline void encodeArg(Buf &buf, T value)
+  {
+    encodeArg(buf, static_cast<std::underlying_type_t<T>>(value));
+  }
+
+  template <typename Buf, typename T>
+  inline void encodeArg(Buf &buf, const Field<T> &field)
+  {
+    size_t length = std::min<size_t>(field.key.size(), UINT8_MAX);
+    buf.push_back(static_cast<char>(ArgType::KEY));
+    buf.push_back(static_cast<char>(length));
+    buf.append(field.key.data(), length);
+    encodeArg(buf, field.value);
+  }
+
+  template <typename Buf, typename... Args>
+  inline void encodeArgs(Buf &buf, const Args &...args)
+  {
+    (encodeArg(buf, args), ...);
+  }
+}
+
+namespace llbe
+{
+  using logfmt::kv;
+}
+
+#endif // LLBE_INCLUDE_LOG_FORMAT_HPP
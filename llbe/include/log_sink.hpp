@@ -0,0 +1,201 @@
+#ifndef LLBE_INCLUDE_LOG_SINK_HPP
+#define LLBE_INCLUDE_LOG_SINK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace llbe
+{
+  /**
+   * Destination for rendered log bytes.
+   *
+   * A sink stages the buffers it is given (by swapping, not copying) and
+   * writes all of them with one vectored write once flush_bytes are staged
+   * or the oldest buffer is flush_interval old. The logger owns its sinks and
+   * only touches them from one thread at a time (under its mutex, or from
+   * the async writer thread).
+   */
+  class LogSink
+  {
+  public:
+    struct Options
+    {
+      size_t flush_bytes = 4096;                     // write once this much is staged
+      std::chrono::microseconds flush_interval{5000}; // ... or the oldest bytes are this old
+      bool io_uring = false;                         // file sinks: submit writes through io_uring
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    explicit LogSink(const Options &options);
+    virtual ~LogSink() = default;
+
+    LogSink(const LogSink &) = delete;
+    LogSink &operator=(const LogSink &) = delete;
+
+    /**
+     * Stage bytes for the next write. The buffer is taken over and data is
+     * left empty (holding a recycled buffer's capacity). Writes the batch if
+     * flush_bytes are now staged.
+     * @param data bytes to write
+     */
+    void append(std::string &data);
+
+    /**
+     * Write everything staged and wait for it to complete
+     * @return false on a write error
+     */
+    bool flush();
+
+    /**
+     * Write the staged bytes if the latency bound has passed
+     * @param now current time
+     */
+    void flushIfDue(Clock::time_point now);
+
+    /**
+     * @return when the staged bytes must be written, Clock::time_point::max()
+     *   if nothing is staged
+     */
+    Clock::time_point flushDeadline() const;
+
+    /**
+     * Flush and make the written bytes durable
+     * @return false on error
+     */
+    virtual bool sync();
+
+    inline size_t stagedBytes() const { return staged_bytes_; }
+
+  protected:
+    enum class WriteResult
+    {
+      DONE,    // buffers may be reused
+      PENDING, // buffers are in flight until waitPending() returns
+      FAILED
+    };
+
+    /**
+     * Write a batch
+     * @param iov buffers in order
+     * @param count number of buffers
+     * @param bytes total size
+     * @return whether the buffers are still in use
+     */
+    virtual WriteResult writeBatch(const iovec *iov, int count, size_t bytes) = 0;
+
+    /**
+     * Wait for a batch that writeBatch() left PENDING
+     * @return false if it failed
+     */
+    virtual bool waitPending() { return true; }
+
+  private:
+    /**
+     * Hand the staged buffers to writeBatch(), which may leave them in flight
+     * @return false on a write error
+     */
+    bool submit();
+
+    /**
+     * Finish the in-flight batch and recycle its buffers
+     * @return false if it failed
+     */
+    bool reap();
+
+    // Keeps the iovec count well below IOV_MAX
+    static constexpr size_t MAX_STAGED = 64;
+
+    Options options_;
+    std::vector<std::string> staged_;
+    std::vector<std::string> in_flight_;
+    std::vector<std::string> spare_;
+    std::vector<iovec> iov_;
+    size_t staged_bytes_ = 0;
+    Clock::time_point first_staged_;
+  };
+
+  /**
+   * Sink writing to a file descriptor with writev(). Used directly for the
+   * console (fd 1 and 2), which it does not close.
+   */
+  class FdSink : public LogSink
+  {
+  public:
+    FdSink(int fd, const Options &options);
+
+  protected:
+    WriteResult writeBatch(const iovec *iov, int count, size_t bytes) override;
+
+    int fd_;
+  };
+
+  /**
+   * Sink that discards everything; measures the logger without any I/O
+   */
+  class NullSink : public LogSink
+  {
+  public:
+    explicit NullSink(const Options &options) : LogSink(options) {}
+
+    /**
+     * @return bytes discarded so far
+     */
+    inline uint64_t bytesDiscarded() const { return discarded_; }
+
+  protected:
+    WriteResult writeBatch(const iovec *, int, size_t bytes) override
+    {
+      discarded_ += bytes;
+      return WriteResult::DONE;
+    }
+
+  private:
+    uint64_t discarded_ = 0;
+  };
+
+  /**
+   * Append-only log file. With Options::io_uring the writes are submitted
+   * to an io_uring and completed on the next flush, so rendering the next
+   * batch overlaps with the write of the previous one. Falls back to
+   * writev() when io_uring is unavailable.
+   */
+  class FileSink : public FdSink
+  {
+  public:
+    /**
+     * Open (create) a file for appending
+     * @param path file path
+     * @param options flush options
+     */
+    FileSink(const std::string &path, const Options &options);
+    ~FileSink() override;
+
+    inline bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * Flush and fdatasync()
+     * @return false on error
+     */
+    bool sync() override;
+
+  protected:
+    WriteResult writeBatch(const iovec *iov, int count, size_t bytes) override;
+    bool waitPending() override;
+
+  private:
+    class Uring;
+    std::unique_ptr<Uring> uring_;
+    const iovec *pending_iov_ = nullptr;
+    int pending_count_ = 0;
+    size_t pending_bytes_ = 0;
+  };
+}
+
+#endif // LLBE_INCLUDE_LOG_SINK_HPP
@@ -7,10 +7,36 @@
 #include <sstream>
 #include <chrono>
 #include <iomanip>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include <concepts>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+#include "flight_recorder.hpp"
+#include "inline_buffer.hpp"
+#include "log_archive.hpp"
+#include "log_sink.hpp"
+#include "mpsc_ring.hpp"
+#include "timestamp.hpp"
+#include "log_format.hpp"
+
+// Levels below this are compiled out of the LOG_* macros entirely
+// (0 = DEBUG ... 4 = CRITICAL). Set through -DLLBE_MIN_LOG_LEVEL=N.
+#ifndef LLBE_MIN_LOG_LEVEL
+#define LLBE_MIN_LOG_LEVEL 0
+#endif
 
 /**
  * Thread-safe logger for the LLBE system
  * Supports different log levels and output to file/console
+ *
+ * In async mode callers only push a record into a bounded lock-free ring;
+ * a dedicated writer thread formats and writes the records in batches.
  */
 class Logger
 {
@@ -24,6 +50,83 @@ public:
     CRITICAL = 4
   };
 
+  /**
+   * Subsystem a message belongs to. Each category has its own threshold so a
+   * single subsystem can be debugged without enabling DEBUG everywhere.
+   */
+  enum class Category
+  {
+    GENERAL = 0,
+    TRUNK = 1,
+    WEBRTC = 2,
+    UDP = 3,
+    CONFIG = 4,
+    COUNT
+  };
+
+  /**
+   * What async producers do when the ring is full
+   */
+  enum class OverflowPolicy
+  {
+    DROP = 0,  // discard the record and count it
+    BLOCK = 1  // wait for the writer thread to make room
+  };
+
+  /**
+   * On-disk representation of the log file. Console output is always text.
+   */
+  enum class FileFormat
+  {
+    TEXT = 0,   // "[ts] [LEVEL] msg" lines
+    BINARY = 1, // compact records, rendered offline by logdecode
+    JSON = 2    // one JSON object per line: ts, level, category, thread, msg, fields
+  };
+
+  struct AsyncOptions
+  {
+    bool enabled = false;
+    size_t queue_capacity = 8192;
+    OverflowPolicy overflow = OverflowPolicy::DROP;
+  };
+
+  /**
+   * Log file rotation. The active file keeps its configured name; closed
+   * segments are renamed to "<file>.<UTC stamp>" and handed to a background
+   * archiver for compression and retention.
+   */
+  struct RotationOptions
+  {
+    uint64_t max_bytes = 0;            // rotate once a segment reaches this size, 0 = never
+    std::chrono::seconds max_age{0};   // rotate segments older than this, 0 = never
+    uint64_t preallocate_bytes = 0;    // fallocate() this much per segment, 0 = off
+    size_t max_files = 0;              // archived segments to keep, 0 = all
+    bool compress = false;             // gzip archived segments
+  };
+
+  /**
+   * Per-call-site state for rate limiting; the LOG_* macros keep one as a
+   * function-local static. The bucket is tracked as a GCRA "theoretical
+   * arrival time" so admitting a message is a single CAS.
+   */
+  struct CallSite
+  {
+    const char *file;
+    int line;
+    std::atomic<int64_t> tat{0};
+    std::atomic<uint64_t> suppressed{0};
+  };
+
+  /**
+   * Counters of lines the logger did not write, for monitoring
+   */
+  struct Stats
+  {
+    uint64_t dropped = 0;      // async ring full
+    uint64_t rate_limited = 0; // call site over its token bucket
+    uint64_t collapsed = 0;    // identical to the previous line
+  };
+
   /**
    * Get singleton instance of logger
    * @return logger instance
@@ -32,7 +135,7 @@ public:
 
   /**
    * Initialize logger with file output
-   * @param filename log file name
+   * @param filename log file name, empty for no log file
    * @param level minimum log level
    * @param console_output also output to console
    * @return true on success, false on failure
@@ -40,15 +143,138 @@ public:
   bool initialize(const std::string &filename, Level level = Level::INFO, bool console_output = true);
 
   /**
-   * Set minimum log level
+   * Initialize logger with file output and an optional async writer
+   * @param filename log file name, empty for no log file (console and
+   *   added sinks only)
+   * @param level minimum log level
+   * @param console_output also output to console
+   * @param async asynchronous writer configuration
+   * @return true on success, false on failure
+   */
+  bool initialize(const std::string &filename, Level level, bool console_output, const AsyncOptions &async);
+
+  /**
+   * Set minimum log level for every category without its own threshold
    * @param level minimum level to log
    */
-  inline void setLevel(Level level)
+  void setLevel(Level level);
+
+  /**
+   * Override the minimum log level of a single category
+   * @param category category to configure
+   * @param level minimum level to log for this category
+   */
+  void setCategoryLevel(Category category, Level level);
+
+  /**
+   * Drop a category override so it follows the global level again
+   * @param category category to reset
+   */
+  void clearCategoryLevel(Category category);
+
+  /**
+   * Select how line timestamps are rendered. Call before logging starts.
+   * @param mode timestamp mode
+   */
+  inline void setTimestampMode(llbe::TimestampFormatter::Mode mode)
+  {
+    timestamps_.setMode(mode);
+  }
+
+  /**
+   * Configure log rotation. Call before initialize().
+   * @param options rotation options
+   */
+  inline void setRotation(const RotationOptions &options)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rotation_ = options;
+  }
+
+  /**
+   * Configure sink batching: writes go out once flush_bytes are staged or
+   * after flush_interval. Only the async writer holds bytes back; the
+   * synchronous path writes every record before returning. Call before
+   * initialize().
+   * @param options sink options
+   */
+  inline void setSinkOptions(const llbe::LogSink::Options &options)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_options_ = options;
+  }
+
+  /**
+   * Add a sink that receives every record as a text line, in addition to
+   * the log file and console. Call before initialize().
+   * @param sink sink to add
+   */
+  void addSink(std::unique_ptr<llbe::LogSink> sink);
+
+  /**
+   * Make CRITICAL records durable: the logging call returns only after the
+   * record has been written and fdatasync()ed
+   * @param enabled true to sync CRITICAL records
+   */
+  inline void setSyncCritical(bool enabled)
+  {
+    sync_critical_.store(enabled, std::memory_order_relaxed);
+  }
+
+  /**
+   * Select the log file format. Call before initialize().
+   * @param format file format
+   */
+  inline void setFileFormat(FileFormat format)
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    min_level_ = level;
+    file_format_ = format;
+  }
+
+  /**
+   * Check whether a message would be logged. Lock-free, safe on hot paths.
+   * @param level log level
+   * @param category message category
+   * @return true if the message passes the threshold
+   */
+  inline bool isEnabled(Level level, Category category = Category::GENERAL) const
+  {
+    return static_cast<int>(level) >=
+      category_levels_[static_cast<size_t>(category)].load(std::memory_order_relaxed);
   }
 
+  /**
+   * Check whether the flight recorder keeps messages of a level. Lock-free.
+   * @param level log level
+   * @return true if the recorder is open and the level passes its threshold
+   */
+  inline bool isRecorded(Level level) const
+  {
+    return static_cast<int>(level) >= recorder_level_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Check whether a message goes anywhere: the log or the flight recorder
+   * @param level log level
+   * @param category message category
+   * @return true if the message should be built
+   */
+  inline bool isWanted(Level level, Category category = Category::GENERAL) const
+  {
+    return isEnabled(level, category) || isRecorded(level);
+  }
+
+  /**
+   * Start the crash-surviving flight recorder. It keeps the last records at
+   * or above its own level, independent of the log level, so a WARNING log
+   * can still come with DEBUG context. Can be opened once per process.
+   * @param path recorder file (dump with flightdump)
+   * @param records number of records to keep
+   * @param level lowest level to record
+   * @return false if the file cannot be mapped or a recorder is already open
+   */
+  bool openFlightRecorder(const std::string &path, size_t records, Level level = Level::DEBUG);
+
   /**
    * Log a debug message
    * @param message message to log
@@ -86,50 +312,554 @@ public:
    */
   void log(Level level, const std::string &message);
 
+  /**
+   * Log a message with specific level and category
+   * @param level log level
+   * @param category message category
+   * @param message message to log
+   */
+  void log(Level level, Category category, const std::string &message);
+
+  /**
+   * Log a message built on demand. The builder only runs if the level is
+   * enabled, so expensive formatting costs nothing when filtered.
+   * @param level log level
+   * @param category message category
+   * @param build callable returning the message
+   */
+  template <typename F>
+    requires std::invocable<F &>
+  inline void log(Level level, Category category, F &&build)
+  {
+    if (isWanted(level, category))
+    {
+      log(level, category, std::string(build()));
+    }
+  }
+
+  /**
+   * Log a "{}"-style format string with deferred formatting. Arguments are
+   * captured raw; text is rendered by the writer (or offline in binary mode).
+   * Use the LOG_*F macros, which register the format string once per site.
+   * Arguments made with llbe::kv() are appended as " key=value" fields.
+   * @param level log level
+   * @param category message category
+   * @param format_id id from llbe::logfmt::registerFormat
+   * @param format the registered format string
+   * @param args arguments for the "{}" placeholders
+   */
+  template <typename... Args>
+  inline void logf(Level level, Category category, uint32_t format_id, const char *format,
+    const Args &...args)
+  {
+    if (!isWanted(level, category))
+    {
+      return;
+    }
+
+    // Encoded straight into the record's inline buffer: no allocation
+    // unless the arguments outgrow it
+    Record record{level, category, timestamps_.now(), {}, format_id, currentThreadId()};
+    llbe::logfmt::encodeArgs(record.message, args...);
+    if (isRecorded(level))
+    {
+      recordFormatted(record, format);
+    }
+    if (!isEnabled(level, category))
+    {
+      return;
+    }
+    logEncoded(std::move(record), format);
+  }
+
   /**
    * Flush all pending log entries
+   * In async mode this waits until the writer thread has drained the ring.
    */
   void flush();
 
+  /**
+   * Number of records discarded because the async ring was full
+   * @return dropped record count since startup
+   */
+  inline uint64_t droppedCount() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Snapshot of the suppression counters
+   * @return counters since startup
+   */
+  Stats stats() const;
+
+  /**
+   * Configure per-call-site rate limiting. Messages at ERROR and above are
+   * never rate limited.
+   * @param per_second sustained messages per second per call site, 0 disables
+   * @param burst messages a call site may emit back to back
+   */
+  void setRateLimit(double per_second, uint32_t burst);
+
+  /**
+   * Collapse runs of identical lines into "last message repeated N times"
+   * @param enabled true to collapse
+   */
+  void setCollapseDuplicates(bool enabled);
+
+  /**
+   * Token-bucket check for a call site, used by the LOG_* macros
+   * @param site call site state
+   * @param level log level
+   * @param category message category
+   * @return true if the message may be logged
+   */
+  inline bool admit(CallSite &site, Level level, Category category)
+  {
+    int64_t interval = rate_interval_ns_.load(std::memory_order_relaxed);
+    if (interval == 0 || level >= Level::ERROR)
+    {
+      return true;
+    }
+
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t tolerance = rate_tolerance_ns_.load(std::memory_order_relaxed);
+    int64_t tat = site.tat.load(std::memory_order_relaxed);
+    do
+    {
+      if (tat - now > tolerance)
+      {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        rate_limited_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    } while (!site.tat.compare_exchange_weak(tat, std::max(tat, now) + interval,
+      std::memory_order_relaxed));
+
+    if (site.suppressed.load(std::memory_order_relaxed) != 0)
+    {
+      reportSuppressed(site, level, category);
+    }
+    return true;
+  }
+
   /**
    * Close log file
    */
   void close();
 
-private:
-  Logger() = default;
-  ~Logger();
+  /**
+   * Parse a config level name ("debug", "info", ...)
+   * @param name level name
+   * @param fallback level returned for unknown names
+   * @return parsed level
+   */
+  static Level levelFromString(const std::string &name, Level fallback = Level::INFO);
+
+  /**
+   * Parse a config overflow policy name ("drop" or "block")
+   * @param name policy name
+   * @return parsed policy, DROP for unknown names
+   */
+  static OverflowPolicy overflowPolicyFromString(const std::string &name);
+
+  /**
+   * Parse a config file format name ("text", "binary" or "json")
+   * @param name format name
+   * @return parsed format, TEXT for unknown names
+   */
+  static FileFormat fileFormatFromString(const std::string &name);
+
+  /**
+   * Convert a file format to its config name
+   * @param format file format
+   * @return format name
+   */
+  static const char *fileFormatToString(FileFormat format);
+
+  /**
+   * Parse a config category name ("trunk", "webrtc", ...)
+   * @param name category name
+   * @param out receives the parsed category
+   * @return false if the name is unknown
+   */
+  static bool categoryFromString(const std::string &name, Category &out);
+
+  /**
+   * Convert category to its config name
+   * @param category category
+   * @return lower-case name
+   */
+  static const char *categoryToString(Category category);
 
   /**
    * Convert log level to string
    * @param level log level
    * @return string representation
    */
-  std::string levelToString(Level level) const;
+  static const char *levelToString(Level level);
+
+  /**
+   * Append one "[ts] [LEVEL] [category] msg" line with trailing newline
+   * @param out buffer to append to
+   * @param timestamps formatter for the stamp
+   * @param level log level
+   * @param category message category
+   * @param time stamp captured by the formatter's clock
+   * @param format format string, nullptr if payload is plain text
+   * @param payload text, or encoded arguments for format
+   */
+  static void appendTextLine(std::string &out, const llbe::TimestampFormatter &timestamps,
+    Level level, Category category, int64_t time, const char *format, std::string_view payload);
+
+private:
+  Logger();
+  ~Logger();
+
+  // Most messages and encoded argument lists fit inline, so records move
+  // through the async ring without allocating
+  static constexpr size_t MESSAGE_INLINE = 200;
+  using Message = llbe::InlineBuffer<MESSAGE_INLINE>;
+
+  struct Record
+  {
+    Level level = Level::INFO;
+    Category category = Category::GENERAL;
+    int64_t time = 0; // from timestamps_.now()
+    Message message; // text, or encoded arguments when format_id is set
+    uint32_t format_id = llbe::logfmt::RAW_TEXT;
+    uint32_t thread = 0; // kernel thread id of the caller
+  };
+
+  /**
+   * @return the calling thread's kernel thread id (cached per thread)
+   */
+  static uint32_t currentThreadId();
+
+  /**
+   * Queue or write a record whose arguments are already encoded
+   * @param record record with encoded arguments
+   * @param format the record's format string
+   */
+  void logEncoded(Record &&record, const char *format);
+
+  /**
+   * Render a record with encoded arguments into the flight recorder
+   * @param record record with encoded arguments
+   * @param format the record's format string
+   */
+  void recordFormatted(const Record &record, const char *format);
+
+  /**
+   * Log a message that passed isEnabled(), without touching the recorder
+   * @param level log level
+   * @param category message category
+   * @param message message to log
+   */
+  void logText(Level level, Category category, const std::string &message);
+
+  /**
+   * Put an internal logger event (drops, rotation) into the flight recorder
+   * @param level event level
+   * @param message event text
+   */
+  void recordEvent(Level level, const std::string &message);
+
+  /**
+   * Log how many messages a call site lost to rate limiting
+   * @param site call site state
+   * @param level level of the message being admitted
+   * @param category category of the message being admitted
+   */
+  void reportSuppressed(CallSite &site, Level level, Category category);
+
+  /**
+   * Rendered bytes on their way to the sinks
+   */
+  struct Output
+  {
+    std::string file;        // file sink, in file_format_
+    std::string console;     // stdout
+    std::string console_err; // stderr (ERROR and above)
+    std::string text;        // text lines for added sinks
+  };
+
+  /**
+   * Append a formatted log line (with trailing newline) to a buffer
+   * @param out buffer to append to
+   * @param record record to format
+   */
+  void appendLine(std::string &out, const Record &record) const;
+
+  /**
+   * Append a record in binary file format, defining its format string first
+   * if this file has not seen it yet
+   * @param out buffer to append to
+   * @param record record to encode
+   */
+  void appendBinary(std::string &out, const Record &record);
+
+  /**
+   * Append a record as one JSON object line. Escapes straight into out,
+   * with json_scratch_ as the only intermediate buffer.
+   * @param out buffer to append to
+   * @param record record to render
+   */
+  void appendJson(std::string &out, const Record &record);
+
+  /**
+   * Render a record for the file, the console if enabled, and added sinks
+   * @param record record to render
+   * @param out buffers to append to
+   */
+  void renderRecord(const Record &record, Output &out);
+
+  /**
+   * Render a record unless it repeats the previous one, in which case it is
+   * only counted. Caller must hold mutex_ or be the writer thread.
+   * @param record record to render
+   * @param out buffers to append to
+   */
+  void emitRecord(const Record &record, Output &out);
+
+  /**
+   * Render the pending "last message repeated N times" line, if any
+   * @param out buffers to append to
+   * @return true if a line was rendered
+   */
+  bool flushRepeats(Output &out);
+
+  /**
+   * Stage rendered buffers on the sinks; they are written once the sinks'
+   * size or latency bound is reached, or on flushSinks(). Leaves out empty.
+   * Caller must hold mutex_ or be the writer thread.
+   * @param out rendered buffers
+   */
+  void writeOut(Output &out);
 
   /**
-   * Get current timestamp as string
-   * @return formatted timestamp
+   * Write everything staged on the sinks
+   * @param durable also fdatasync() the log file
    */
-  std::string getCurrentTimestamp() const;
+  void flushSinks(bool durable = false);
 
   /**
-   * Write log entry
+   * Call f for the file, console and added sinks that exist
+   * @param f callable taking llbe::LogSink &
+   */
+  template <typename F>
+  inline void forEachSink(F &&f) const
+  {
+    if (file_sink_)
+      f(*file_sink_);
+    if (stdout_sink_)
+      f(*stdout_sink_);
+    if (stderr_sink_)
+      f(*stderr_sink_);
+    for (const auto &sink : sinks_)
+      f(*sink);
+  }
+
+  /**
+   * @return earliest time a sink must write its staged bytes
+   */
+  llbe::LogSink::Clock::time_point sinkDeadline() const;
+
+  /**
+   * Caller side of the durable CRITICAL path: wait until the record is on disk
+   * @param level level of the record just logged
+   */
+  inline void syncIfCritical(Level level)
+  {
+    if (level == Level::CRITICAL && sync_critical_.load(std::memory_order_relaxed))
+    {
+      flush();
+    }
+  }
+
+  /**
+   * Write log entry synchronously, caller must hold mutex_
    * @param level log level
+   * @param category message category
    * @param message message to log
    */
-  void writeLog(Level level, const std::string &message);
+  void writeLog(Level level, Category category, const std::string &message);
+
+  /**
+   * Write a record synchronously, caller must hold mutex_
+   * @param record record to write
+   */
+  void writeRecord(const Record &record);
+
+  /**
+   * Recompute the per-category thresholds, caller must hold mutex_
+   */
+  void applyLevels();
+
+  /**
+   * Hand a record to the async writer thread, applying the overflow policy
+   * @param record record to enqueue
+   */
+  void enqueue(Record &&record);
+
+  /**
+   * Async writer thread body: drains the ring and writes batches
+   */
+  void writerLoop();
+
+  /**
+   * Open (or reopen) the active log file and write the binary header.
+   * Caller must hold mutex_ or be the writer thread.
+   * @return false if the file cannot be opened
+   */
+  bool openSegment();
+
+  /**
+   * Rotate the active file once it is over its size or age limit, or retry
+   * opening it if the last rotation could not.
+   * Caller must hold mutex_ or be the writer thread.
+   */
+  void rotateIfNeeded();
+
+  /**
+   * Write up to one batch of queued records
+   * @return number of records written
+   */
+  size_t drainBatch();
+
+  /**
+   * Stop the writer thread after it has drained the ring
+   */
+  void stopWriter();
 
   std::mutex mutex_;
-  std::ofstream file_;
+  Output sync_out_; // render buffers for the synchronous path
   Level min_level_ = Level::INFO;
+  Level category_overrides_[static_cast<size_t>(Category::COUNT)] = {};
+  uint32_t category_override_mask_ = 0;
+  std::atomic<int> category_levels_[static_cast<size_t>(Category::COUNT)] = {};
   bool console_output_ = true;
   bool initialized_ = false;
+  llbe::TimestampFormatter timestamps_;
+  FileFormat file_format_ = FileFormat::TEXT;
+  std::vector<bool> defined_formats_; // binary mode: format ids already in this file
+  std::string json_scratch_; // JSON mode: message text before escaping
+
+  // Rotation
+  std::string filename_;
+  RotationOptions rotation_;
+  uint64_t segment_bytes_ = 0;
+  std::chrono::steady_clock::time_point segment_opened_;
+  bool reopen_pending_ = false; // rotation renamed the file but could not open a new one
+  std::unique_ptr<llbe::LogArchiver> archiver_;
+
+  // Sinks
+  llbe::LogSink::Options sink_options_;
+  std::unique_ptr<llbe::FileSink> file_sink_;
+  std::unique_ptr<llbe::FdSink> stdout_sink_;
+  std::unique_ptr<llbe::FdSink> stderr_sink_;
+  std::vector<std::unique_ptr<llbe::LogSink>> sinks_; // added with addSink()
+  std::atomic<bool> sync_critical_{false};
+
+  // Flight recorder; the mapping lives as long as the logger
+  llbe::FlightRecorder recorder_;
+  std::atomic<int> recorder_level_{INT_MAX}; // INT_MAX while closed
+
+  // Rate limiting and duplicate collapsing
+  std::atomic<int64_t> rate_interval_ns_{0};
+  std::atomic<int64_t> rate_tolerance_ns_{0};
+  std::atomic<uint64_t> rate_limited_{0};
+  std::atomic<uint64_t> collapsed_{0};
+  std::atomic<bool> collapse_duplicates_{false};
+  Record last_record_;
+  bool have_last_record_ = false;
+  uint64_t repeat_count_ = 0;
+
+  // Async mode
+  static constexpr size_t ASYNC_BATCH_SIZE = 256;
+  static constexpr std::chrono::milliseconds ASYNC_IDLE_WAIT{50};
+
+  std::unique_ptr<llbe::MpscRing<Record>> ring_;
+  OverflowPolicy overflow_ = OverflowPolicy::DROP;
+  std::atomic<bool> async_{false};
+  std::thread writer_;
+  std::mutex writer_mutex_;
+  std::condition_variable writer_cv_;
+  std::condition_variable drained_cv_;
+  std::atomic<bool> writer_idle_{false};
+  std::atomic<bool> writer_stop_{false};
+  std::atomic<uint64_t> enqueued_{0};
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  uint64_t dropped_reported_ = 0;
+  std::atomic<uint64_t> flush_requests_{0};
+  std::atomic<uint64_t> flushes_done_{0};
+  Output batch_;
 };
 
+// The message expression is only evaluated when the level is enabled (or
+// recorded by the flight recorder) and the call site is within its rate
+// limit. Levels below LLBE_MIN_LOG_LEVEL generate no code (the discarded
+// branch is still type-checked).
+#define LLBE_LOG_AT(lvl, cat, msg)                                                    \
+  do                                                                                \
+  {                                                                                 \
+    if constexpr (static_cast<int>(Logger::Level::lvl) >= LLBE_MIN_LOG_LEVEL)       \
+    {                                                                               \
+      Logger &llbe_logger_ = Logger::getInstance();                                 \
+      if (llbe_logger_.isWanted(Logger::Level::lvl, Logger::Category::cat))         \
+      {                                                                             \
+        static Logger::CallSite llbe_site_{__FILE__, __LINE__};                     \
+        if (llbe_logger_.admit(llbe_site_, Logger::Level::lvl,                    \
+              Logger::Category::cat))                                             \
+          llbe_logger_.log(Logger::Level::lvl, Logger::Category::cat, (msg));       \
+      }                                                                             \
+    }                                                                               \
+  } while (0)
+
 // Convenience macros for logging
-#define LOG_DEBUG(msg) Logger::getInstance().debug(msg)
-#define LOG_INFO(msg) Logger::getInstance().info(msg)
-#define LOG_WARNING(msg) Logger::getInstance().warning(msg)
-#define LOG_ERROR(msg) Logger::getInstance().error(msg)
-#define LOG_CRITICAL(msg) Logger::getInstance().critical(msg)
+#define LOG_DEBUG(msg) LLBE_LOG_AT(DEBUG, GENERAL, msg)
+#define LOG_INFO(msg) LLBE_LOG_AT(INFO, GENERAL, msg)
+#define LOG_WARNING(msg) LLBE_LOG_AT(WARNING, GENERAL, msg)
+#define LOG_ERROR(msg) LLBE_LOG_AT(ERROR, GENERAL, msg)
+#define LOG_CRITICAL(msg) LLBE_LOG_AT(CRITICAL, GENERAL, msg)
+
+// Deferred-format variants, e.g. LOG_INFOF("session {} size={}", id, n).
+// The format string must be a literal; it is registered once per call site.
+#define LLBE_LOGF_AT(lvl, cat, fmt, ...)                                              \
+  do                                                                                \
+  {                                                                                 \
+    if constexpr (static_cast<int>(Logger::Level::lvl) >= LLBE_MIN_LOG_LEVEL)       \
+    {                                                                               \
+      Logger &llbe_logger_ = Logger::getInstance();                                 \
+      if (llbe_logger_.isWanted(Logger::Level::lvl, Logger::Category::cat))         \
+      {                                                                             \
+        static Logger::CallSite llbe_site_{__FILE__, __LINE__};                     \
+        static const uint32_t llbe_format_id_ = llbe::logfmt::registerFormat(fmt);  \
+        if (llbe_logger_.admit(llbe_site_, Logger::Level::lvl,                    \
+              Logger::Category::cat))                                             \
+          llbe_logger_.logf(Logger::Level::lvl, Logger::Category::cat,              \
+            llbe_format_id_, fmt __VA_OPT__(,) __VA_ARGS__);                        \
+      }                                                                             \
+    }                                                                               \
+  } while (0)
+
+// Category-tagged variants, e.g. LOG_CAT_DEBUG(TRUNK, "...")
+#define LOG_CAT_DEBUG(cat, msg) LLBE_LOG_AT(DEBUG, cat, msg)
+#define LOG_CAT_INFO(cat, msg) LLBE_LOG_AT(INFO, cat, msg)
+#define LOG_CAT_WARNING(cat, msg) LLBE_LOG_AT(WARNING, cat, msg)
+#define LOG_CAT_ERROR(cat, msg) LLBE_LOG_AT(ERROR, cat, msg)
+#define LOG_CAT_CRITICAL(cat, msg) LLBE_LOG_AT(CRITICAL, cat, msg)
+
+#define LOG_DEBUGF(fmt, ...) LLBE_LOGF_AT(DEBUG, GENERAL, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_INFOF(fmt, ...) LLBE_LOGF_AT(INFO, GENERAL, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_WARNINGF(fmt, ...) LLBE_LOGF_AT(WARNING, GENERAL, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_ERRORF(fmt, ...) LLBE_LOGF_AT(ERROR, GENERAL, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CRITICALF(fmt, ...) LLBE_LOGF_AT(CRITICAL, GENERAL, fmt __VA_OPT__(,) __VA_ARGS__)
+
+#define LOG_CAT_DEBUGF(cat, fmt, ...) LLBE_LOGF_AT(DEBUG, cat, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CAT_INFOF(cat, fmt, ...) LLBE_LOGF_AT(INFO, cat, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CAT_WARNINGF(cat, fmt, ...) LLBE_LOGF_AT(WARNING, cat, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CAT_ERRORF(cat, fmt, ...) LLBE_LOGF_AT(ERROR, cat, fmt __VA_OPT__(,) __VA_ARGS__)
+#define LOG_CAT_CRITICALF(cat, fmt, ...) LLBE_LOGF_AT(CRITICAL, cat, fmt __VA_OPT__(,) __VA_ARGS__)
@@ -0,0 +1,121 @@
+#ifndef LLBE_INCLUDE_MPSC_RING_HPP
+#define LLBE_INCLUDE_MPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace llbe
+{
+  /**
+   * Bounded lock-free multi-producer / single-consumer ring.
+   *
+   * Each cell carries a sequence number (Vyukov's bounded queue): producers
+   * claim a slot with a CAS on the tail and publish it by bumping the cell
+   * sequence, so a full ring is detected without touching the consumer side.
+   * Capacity is rounded up to a power of two.
+   */
+  template <typename T>
+  class MpscRing
+  {
+  public:
+    explicit MpscRing(size_t capacity)
+    {
+      capacity_ = 1;
+      while (capacity_ < capacity)
+        capacity_ <<= 1;
+      mask_ = capacity_ - 1;
+
+      cells_ = std::make_unique<Cell[]>(capacity_);
+      for (size_t i = 0; i < capacity_; ++i)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    /**
+     * Try to enqueue an element
+     * @param value element to move into the ring
+     * @return false if the ring is full (value is left untouched)
+     */
+    bool tryPush(T &&value)
+    {
+      size_t pos = tail_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        Cell &cell = cells_[pos & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0)
+        {
+          if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            cell.value = std::move(value);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        }
+        else if (diff < 0)
+        {
+          return false;
+        }
+        else
+        {
+          pos = tail_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /**
+     * Try to dequeue an element. Must only be called from the consumer thread.
+     * @param out receives the element
+     * @return false if the ring is empty
+     */
+    bool tryPop(T &out)
+    {
+      size_t pos = head_.load(std::memory_order_relaxed);
+      Cell &cell = cells_[pos & mask_];
+      size_t seq = cell.sequence.load(std::memory_order_acquire);
+      if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0)
+        return false;
+
+      out = std::move(cell.value);
+      cell.sequence.store(pos + capacity_, std::memory_order_release);
+      head_.store(pos + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /**
+     * Approximate emptiness check, safe from any thread
+     */
+    bool empty() const
+    {
+      size_t pos = head_.load(std::memory_order_relaxed);
+      const Cell &cell = cells_[pos & mask_];
+      size_t seq = cell.sequence.load(std::memory_order_acquire);
+      return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> sequence{0};
+      T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+  };
+}
+
+#endif // LLBE_INCLUDE_MPSC_RING_HPP
@@ -0,0 +1,93 @@
+#ifndef LLBE_INCLUDE_MULTICAST_SINK_HPP
+#define LLBE_INCLUDE_MULTICAST_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "log_sink.hpp"
+#include "mpsc_ring.hpp"
+
+namespace llbe
+{
+  /**
+   * Sends log lines to UDP multicast groups, one line per datagram without
+   * the trailing newline, which is what the loglistener utility prints.
+   *
+   * The logger only pushes lines into a bounded queue; a sender thread drains
+   * it with sendmmsg(). When the queue (or the socket buffer) is full, lines
+   * are dropped and counted, so a slow network never stalls logging.
+   */
+  class MulticastSink : public LogSink
+  {
+  public:
+    // Longest datagram payload; fits an Ethernet frame without fragmenting
+    static constexpr size_t MAX_DATAGRAM = 1472;
+
+    struct Group
+    {
+      std::string address;
+      uint16_t port = 12345;
+    };
+
+    /**
+     * @param groups destinations
+     * @param queue_lines queue capacity in lines
+     * @param ttl multicast TTL (1 keeps packets on the local network)
+     * @param options flush options
+     */
+    MulticastSink(const std::vector<Group> &groups, size_t queue_lines, int ttl, const Options &options);
+    ~MulticastSink() override;
+
+    /**
+     * @return true if the socket is open and at least one group is valid
+     */
+    bool isOpen() const { return sock_ >= 0 && !destinations_.empty(); }
+
+    /**
+     * @return lines dropped because the queue was full, plus datagrams the
+     *   socket buffer could not take
+     */
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * Parse "address[:port]" as accepted by loglistener
+     * @param spec group spec
+     * @param out receives the parsed group
+     * @return false if the port is invalid
+     */
+    static bool parseGroup(const std::string &spec, Group &out);
+
+  protected:
+    WriteResult writeBatch(const iovec *iov, int count, size_t bytes) override;
+
+  private:
+    void senderLoop();
+
+    /**
+     * Send queued lines to every destination
+     * @param lines lines without newline
+     */
+    void sendLines(const std::vector<std::string> &lines);
+
+    int sock_ = -1;
+    std::vector<sockaddr_in> destinations_;
+    MpscRing<std::string> queue_;
+    std::atomic<uint64_t> dropped_{0};
+
+    std::thread sender_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+  };
+}
+
+#endif // LLBE_INCLUDE_MULTICAST_SINK_HPP
@@ -0,0 +1,107 @@
+#ifndef LLBE_INCLUDE_SHA256_BACKEND_HPP
+#define LLBE_INCLUDE_SHA256_BACKEND_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * SHA-256 compression kernels behind crypto::sha256_hash.
+ *
+ * Every kernel has the same shape: compress n consecutive 64-byte blocks
+ * into the state. The first kernel in backends() that the CPU supports
+ * (cpuid on x86, hwcaps on ARM) is picked on first use; the scalar kernel
+ * is always last and always supported.
+ */
+namespace crypto::sha256
+{
+  using BlockFn = void (*)(uint32_t state[8], const uint8_t *blocks, size_t n);
+
+  struct Backend
+  {
+    const char *name;
+    BlockFn blocks;
+    bool (*supported)(); // runtime CPU check
+  };
+
+  // Round constants, 16-byte aligned for vector loads
+  extern const uint32_t K[64];
+
+  /**
+   * @return compiled-in backends, preferred first, scalar last
+   */
+  std::span<const Backend> backends();
+
+  /**
+   * @return the backend crypto::sha256_hash uses on this CPU
+   */
+  const Backend &active();
+
+  /**
+   * Hash with a specific backend (tests, benchmarks)
+   * @param backend backend to use, must be supported
+   * @param data message
+   * @param len message length in bytes
+   * @param out digest
+   */
+  void hash(const Backend &backend, const uint8_t *data, size_t len, uint8_t out[32]);
+
+  void blocksScalar(uint32_t state[8], const uint8_t *blocks, size_t n);
+
+  // Hash `lanes` independent messages at once; every lane must be filled
+  using LanesFn = void (*)(const uint8_t *const data[], const size_t len[], uint8_t out[][32]);
+
+  // Most lanes any batch backend uses
+  constexpr size_t MAX_LANES = 16;
+
+  struct BatchBackend
+  {
+    const char *name;
+    size_t lanes;
+    LanesFn hash;
+    bool (*supported)(); // runtime CPU check
+  };
+
+  /**
+   * @return compiled-in batch backends, preferred first, a single-lane
+   *         wrapper around the scalar kernel last
+   */
+  std::span<const BatchBackend> batchBackends();
+
+  /**
+   * @return the batch backend crypto::sha256_verify_batch uses on this CPU
+   */
+  const BatchBackend &activeBatch();
+
+  /**
+   * Hash count messages with a specific batch backend (tests, benchmarks)
+   * @param backend backend to use, must be supported
+   * @param data message start per message
+   * @param len message length per message
+   * @param out digest per message
+   * @param count number of messages, any
+   */
+  void hashBatch(const BatchBackend &backend, const uint8_t *const data[], const size_t len[], uint8_t out[][32], size_t count);
+
+  // Multi-buffer kernels (sha256_mb.cpp)
+  void hashLanes4(const uint8_t *const data[], const size_t len[], uint8_t out[][32]);
+
+#if defined(__x86_64__) || defined(__i386__)
+  // SHA extensions (SHA-NI), needs SSSE3 and SSE4.1 too
+  void blocksShaNi(uint32_t state[8], const uint8_t *blocks, size_t n);
+  bool cpuHasShaNi();
+
+  void hashLanes8Avx2(const uint8_t *const data[], const size_t len[], uint8_t out[][32]);
+  void hashLanes16Avx512(const uint8_t *const data[], const size_t len[], uint8_t out[][32]);
+  bool cpuHasAvx2();
+  bool cpuHasAvx512();
+#endif
+
+#if defined(__aarch64__) && defined(LLBE_SHA256_ARMV8)
+  // ARMv8 cryptography extensions (opt-in until verified on hardware)
+  void blocksArmv8(uint32_t state[8], const uint8_t *blocks, size_t n);
+  bool cpuHasArmv8Sha2();
+#endif
+}
+
+#endif // LLBE_INCLUDE_SHA256_BACKEND_HPP
@@ -0,0 +1,81 @@
+#ifndef LLBE_INCLUDE_TIMESTAMP_HPP
+#define LLBE_INCLUDE_TIMESTAMP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace llbe
+{
+  /**
+   * Fast timestamp formatter for log lines.
+   *
+   * Wall-clock modes keep a per-thread cache of the formatted
+   * "YYYY-MM-DD HH:MM:SS" prefix, so localtime_r()/gmtime_r() only run when
+   * the second changes; every other call just rewrites the sub-second digits.
+   */
+  class TimestampFormatter
+  {
+  public:
+    enum class Mode
+    {
+      LOCAL = 0,     // 2025-01-31 13:37:00.123 (local time)
+      UTC = 1,       // 2025-01-31T13:37:00.123Z
+      MONOTONIC = 2, // 12345.678901 (steady clock seconds)
+      EPOCH_US = 3   // 1738330620123456 (microseconds since the Unix epoch)
+    };
+
+    // Longest formatted timestamp, without terminator
+    static constexpr size_t MAX_LENGTH = 32;
+
+    explicit TimestampFormatter(Mode mode = Mode::LOCAL) : mode_(mode) {}
+
+    inline void setMode(Mode mode) { mode_.store(mode, std::memory_order_relaxed); }
+    inline Mode mode() const { return mode_.load(std::memory_order_relaxed); }
+
+    /**
+     * Capture the current time on the clock used by the active mode
+     * @return nanoseconds since that clock's epoch
+     */
+    inline int64_t now() const
+    {
+      if (mode() == Mode::MONOTONIC)
+      {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Format a stamp captured with now()
+     * @param stamp_ns nanoseconds since the clock's epoch
+     * @param out buffer of at least MAX_LENGTH bytes (not NUL-terminated)
+     * @return number of characters written
+     */
+    size_t format(int64_t stamp_ns, char *out) const;
+
+    /**
+     * Format a stamp into a new string
+     * @param stamp_ns nanoseconds since the clock's epoch
+     * @return formatted timestamp
+     */
+    std::string toString(int64_t stamp_ns) const;
+
+    /**
+     * Parse a config mode name ("local", "utc", "monotonic", "epoch_us")
+     * @param name mode name
+     * @param out receives the parsed mode
+     * @return false if the name is unknown
+     */
+    static bool modeFromString(const std::string &name, Mode &out);
+
+  private:
+    std::atomic<Mode> mode_;
+  };
+}
+
+#endif // LLBE_INCLUDE_TIMESTAMP_HPP
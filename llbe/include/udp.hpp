@@ -6,6 +6,9 @@
 #include <chrono>
 #include <functional>
 
+#include "bundle.hpp"
+#include "link.hpp"
+
 namespace llbe
 {
   class RobotUDPSession
@@ -15,18 +18,62 @@ namespace llbe
     std::string bind_address_;
     uint16_t bind_port_;
     std::chrono::time_point<std::chrono::steady_clock> last_hb_;
+    shr::BundleEncoder bundle_; // messages queued for the next datagram
+    uint32_t tx_sequence_ = 0;
+    shr::LinkReceiver rx_;
+
+    bool send_datagram(const uint8_t* data, size_t len);
 
   public:
-    inline RobotUDPSession(int fd, const std::string &address, uint16_t port) :
+    /**
+     * @param fd connected UDP socket, owned by the session
+     * @param mtu largest datagram queue_message() packs
+     * @param integrity trailer of packed datagrams; must cover every
+     *        message type queued (commands need HMAC)
+     * @param max_age_us received datagrams in flight this much longer than
+     *        the recent fastest one are stale; 0 (default) disables the check
+     */
+    inline RobotUDPSession(int fd, const std::string &address, uint16_t port,
+                           size_t mtu = shr::DEFAULT_BUNDLE_MTU,
+                           shr::Integrity integrity = shr::Integrity::HMAC_SHA256_128,
+                           uint32_t max_age_us = 0) :
       sockfd_(fd),
       bind_address_(address),
       bind_port_(port),
-      last_hb_(std::chrono::steady_clock::now())
+      last_hb_(std::chrono::steady_clock::now()),
+      bundle_(mtu, integrity),
+      rx_(max_age_us)
     { }
 
     virtual ~RobotUDPSession();
 
     void send_message(const std::string& message);
+
+    /**
+     * Queue a message for the next datagram. A full datagram is sent first
+     * when the message does not fit; call flush() at the end of each
+     * control/telemetry tick.
+     * @return false if the message can never fit in one datagram
+     */
+    bool queue_message(uint8_t message_type, const uint8_t* payload, size_t len);
+
+    /**
+     * Send the queued messages as one datagram, if any
+     */
+    void flush();
+
+    /**
+     * Run a verified datagram from the peer through the replay window
+     * @param frame decoded datagram
+     * @return admission; pass it to shr::admits() for each message inside
+     */
+    shr::Admission admit(const shr::FrameView& frame);
+
+    /**
+     * @return loss, reorder and jitter counters of datagrams from the peer
+     */
+    inline shr::LinkStats link_stats() const { return rx_.stats(); }
+
     void on_message(std::function<void(const std::string&)> callback);
     void backgroundTask();
   };
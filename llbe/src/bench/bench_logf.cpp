@@ -0,0 +1,135 @@
+/**
+ * bench_logf.cpp
+ *
+ * Compares the cost of a typical log line built by std::string
+ * concatenation (LOG_INFO) with the same line through the format API
+ * (LOG_INFOF, with and without key/value fields): ns per call and heap
+ * allocations per call, counted by replacing the global operator new.
+ * Allocations on the async writer thread are included.
+ *
+ * Exits non-zero if a LOG_INFOF call allocates in steady state.
+ */
+
+#include "logger.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+
+namespace
+{
+  constexpr int ITERATIONS = 200000;
+  constexpr const char *LOG_FILE = "bench_logf.log";
+
+  std::atomic<uint64_t> allocations{0};
+
+  struct Result
+  {
+    double ns_per_op;
+    double allocs_per_op;
+  };
+
+  template <typename F>
+  Result measure(F &&fn)
+  {
+    // warm up: grows the sink and scratch buffers to their steady size
+    for (int i = 0; i < ITERATIONS / 10; ++i)
+      fn(i);
+    Logger::getInstance().flush();
+
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+      fn(i);
+    Logger::getInstance().flush();
+    auto end = std::chrono::steady_clock::now();
+    uint64_t after = allocations.load(std::memory_order_relaxed);
+
+    return Result{
+      std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS,
+      static_cast<double>(after - before) / ITERATIONS,
+    };
+  }
+}
+
+void *operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+int main()
+{
+  Logger &logger = Logger::getInstance();
+  logger.setRateLimit(0, 0);
+  logger.setCollapseDuplicates(false);
+
+  const std::string session = "4f6c2a90-sess";
+  bool ok = true;
+
+  std::printf("%-8s %-8s %10s %12s\n", "mode", "api", "ns/op", "allocs/op");
+  for (bool async : {false, true})
+  {
+    Logger::AsyncOptions options;
+    options.enabled = async;
+    options.overflow = Logger::OverflowPolicy::BLOCK;
+    if (!logger.initialize(LOG_FILE, Logger::Level::INFO, false, options))
+    {
+      std::fprintf(stderr, "cannot open %s\n", LOG_FILE);
+      return 1;
+    }
+
+    Result concat = measure([&](int i) {
+      LOG_INFO("PeerConnection state for session " + session + ": " + std::to_string(i));
+    });
+    Result format = measure([&](int i) {
+      LOG_INFOF("PeerConnection state for session {}: {}", session, i);
+    });
+    Result fields = measure([&](int i) {
+      LOG_INFOF("PeerConnection state", llbe::kv("session", session), llbe::kv("state", i));
+    });
+
+    const char *mode = async ? "async" : "sync";
+    std::printf("%-8s %-8s %10.1f %12.3f\n", mode, "concat", concat.ns_per_op, concat.allocs_per_op);
+    std::printf("%-8s %-8s %10.1f %12.3f\n", mode, "format", format.ns_per_op, format.allocs_per_op);
+    std::printf("%-8s %-8s %10.1f %12.3f\n", mode, "fields", fields.ns_per_op, fields.allocs_per_op);
+
+    // Allow the odd buffer regrowth, not one allocation per call
+    ok = ok && format.allocs_per_op < 0.01 && fields.allocs_per_op < 0.01;
+    logger.close();
+  }
+
+  std::filesystem::remove(LOG_FILE);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/**
+ * bench_logger.cpp
+ *
+ * Logger throughput and contention. Every combination of
+ *   sink:    file, console (stdout redirected to /dev/null), null (no I/O)
+ *   mode:    sync, async (overflow "block", so every record is written)
+ *   level:   enabled (INFO at INFO) and filtered (DEBUG at INFO)
+ *   threads: 1, 2, 4, ... up to the limit
+ * is run, and one JSON object per case is printed to stdout:
+ *
+ *   {"sink":"file","mode":"async","level":"enabled","threads":4,"ops":400000,
+ *    "ns_per_op":..,"p50_ns":..,"p99_ns":..,"max_ns":..,"mops":..}
+ *
+ * ns_per_op and the percentiles are per call, seen by the calling thread
+ * (each call is timed, which adds the clock overhead). mops is the total
+ * throughput in million calls per second of wall time, including the final
+ * flush.
+ *
+ * Usage: bench_logger [max_threads] [ops_per_thread]
+ */
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+  constexpr const char *LOG_FILE = "bench_logger.log";
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Case
+  {
+    const char *sink;
+    bool async;
+    bool enabled;
+    int threads;
+  };
+
+  struct Result
+  {
+    uint64_t ops;
+    double ns_per_op;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double mops;
+  };
+
+  /**
+   * Log ops_per_thread lines from each of c.threads threads
+   * @param latencies reused sample buffer
+   */
+  Result run(const Case &c, int ops_per_thread, std::vector<uint32_t> &latencies)
+  {
+    size_t total = static_cast<size_t>(ops_per_thread) * static_cast<size_t>(c.threads);
+    latencies.resize(total);
+
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int t = 0; t < c.threads; ++t)
+    {
+      threads.emplace_back([&, t]() {
+        uint32_t *samples = latencies.data() + static_cast<size_t>(t) * ops_per_thread;
+        for (int i = 0; i < ops_per_thread; ++i)
+        {
+          auto before = Clock::now();
+          if (c.enabled)
+            LOG_INFOF("bench thread {} iteration {} value {}", t, i, 0.5 * i);
+          else
+            LOG_DEBUGF("bench thread {} iteration {} value {}", t, i, 0.5 * i);
+          auto after = Clock::now();
+          samples[i] = static_cast<uint32_t>(std::min<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count(), UINT32_MAX));
+        }
+      });
+    }
+    for (auto &thread : threads)
+      thread.join();
+    Logger::getInstance().flush();
+    double wall_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    uint64_t sum = 0;
+    for (uint32_t ns : latencies)
+      sum += ns;
+
+    auto percentile = [&](double p) -> uint64_t {
+      size_t index = std::min(total - 1, static_cast<size_t>(p * static_cast<double>(total)));
+      std::nth_element(latencies.begin(), latencies.begin() + static_cast<ptrdiff_t>(index), latencies.end());
+      return latencies[index];
+    };
+
+    Result result;
+    result.ops = total;
+    result.ns_per_op = static_cast<double>(sum) / static_cast<double>(total);
+    result.p50_ns = percentile(0.50);
+    result.p99_ns = percentile(0.99);
+    result.max_ns = *std::max_element(latencies.begin(), latencies.end());
+    result.mops = static_cast<double>(total) * 1e3 / wall_ns;
+    return result;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int max_threads = static_cast<int>(std::max(1u, std::min(8u, std::thread::hardware_concurrency())));
+  int ops_per_thread = 100000;
+  if (argc > 1)
+    max_threads = std::max(1, std::atoi(argv[1]));
+  if (argc > 2)
+    ops_per_thread = std::max(1, std::atoi(argv[2]));
+
+  // Results go to the original stdout; fd 1 is pointed at /dev/null while
+  // the console sink runs
+  int results_fd = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  if (results_fd < 0 || null_fd < 0)
+  {
+    std::perror("bench_logger");
+    return 1;
+  }
+
+  Logger &logger = Logger::getInstance();
+  logger.setRateLimit(0, 0);
+  logger.setCollapseDuplicates(false);
+
+  std::vector<int> thread_counts;
+  for (int n = 1; n < max_threads; n *= 2)
+    thread_counts.push_back(n);
+  thread_counts.push_back(max_threads);
+
+  std::vector<uint32_t> latencies;
+  bool null_sink_added = false;
+
+  for (const char *sink : {"file", "console", "null"})
+  {
+    std::string name = sink;
+    if (name == "console")
+    {
+      std::fflush(stdout);
+      dup2(null_fd, STDOUT_FILENO);
+    }
+    else
+    {
+      dup2(results_fd, STDOUT_FILENO);
+    }
+    if (name == "null" && !null_sink_added)
+    {
+      // Added sinks outlive close(); this case runs last
+      logger.addSink(std::make_unique<llbe::NullSink>(llbe::LogSink::Options()));
+      null_sink_added = true;
+    }
+
+    for (bool async : {false, true})
+    {
+      for (bool enabled : {true, false})
+      {
+        for (int threads : thread_counts)
+        {
+          Logger::AsyncOptions options;
+          options.enabled = async;
+          options.overflow = Logger::OverflowPolicy::BLOCK;
+          if (!logger.initialize(name == "file" ? LOG_FILE : "", Logger::Level::INFO, name == "console", options))
+          {
+            dprintf(STDERR_FILENO, "bench_logger: cannot initialize the %s sink\n", sink);
+            return 1;
+          }
+
+          Case c{sink, async, enabled, threads};
+          Result r = run(c, ops_per_thread, latencies);
+          logger.close();
+          std::filesystem::remove(LOG_FILE);
+
+          dprintf(results_fd,
+            "{\"sink\":\"%s\",\"mode\":\"%s\",\"level\":\"%s\",\"threads\":%d,\"ops\":%llu,"
+            "\"ns_per_op\":%.1f,\"p50_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu,\"mops\":%.3f}\n",
+            sink, async ? "async" : "sync", enabled ? "enabled" : "filtered", threads,
+            static_cast<unsigned long long>(r.ops), r.ns_per_op,
+            static_cast<unsigned long long>(r.p50_ns), static_cast<unsigned long long>(r.p99_ns),
+            static_cast<unsigned long long>(r.max_ns), r.mops);
+        }
+      }
+    }
+  }
+
+  dup2(results_fd, STDOUT_FILENO);
+  close(results_fd);
+  close(null_fd);
+  return 0;
+}
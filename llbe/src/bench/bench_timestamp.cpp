@@ -0,0 +1,102 @@
+/**
+ * bench_timestamp.cpp
+ *
+ * Measures the cost of producing one log line timestamp with
+ * llbe::TimestampFormatter in every mode, next to the old
+ * localtime + put_time + stringstream approach for reference.
+ *
+ * Exits non-zero if any formatter mode exceeds the per-stamp budget.
+ */
+
+#include "timestamp.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace
+{
+  constexpr int ITERATIONS = 2000000;
+  constexpr double BUDGET_NS = 100.0;
+
+  volatile size_t sink = 0;
+
+  template <typename F>
+  double measure(F &&fn)
+  {
+    // warm up caches and the per-thread second cache
+    for (int i = 0; i < ITERATIONS / 10; ++i)
+      fn(i);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+      fn(i);
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS;
+  }
+
+  std::string legacyTimestamp()
+  {
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now.time_since_epoch()
+    ) % 1000;
+
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+    return ss.str();
+  }
+}
+
+int main()
+{
+  using Mode = llbe::TimestampFormatter::Mode;
+  struct Case
+  {
+    const char *name;
+    Mode mode;
+  };
+  const Case cases[] = {
+    {"local", Mode::LOCAL},
+    {"utc", Mode::UTC},
+    {"monotonic", Mode::MONOTONIC},
+    {"epoch_us", Mode::EPOCH_US},
+  };
+
+  bool ok = true;
+  std::printf("%-12s %14s %14s\n", "mode", "format ns/op", "now+fmt ns/op");
+
+  for (const auto &c : cases)
+  {
+    llbe::TimestampFormatter formatter(c.mode);
+    char buf[llbe::TimestampFormatter::MAX_LENGTH];
+
+    // Format only: advance 1us per call so second rollovers are included
+    int64_t base = formatter.now();
+    double format_ns = measure([&](int i) {
+      sink = sink + formatter.format(base + static_cast<int64_t>(i) * 1000, buf);
+    });
+
+    // What a log call pays: read the clock and format
+    double full_ns = measure([&](int) {
+      sink = sink + formatter.format(formatter.now(), buf);
+    });
+
+    std::printf("%-12s %14.1f %14.1f %s\n", c.name, format_ns, full_ns,
+      full_ns < BUDGET_NS ? "" : "(over budget)");
+    ok = ok && full_ns < BUDGET_NS;
+  }
+
+  double legacy_ns = measure([](int) {
+    sink = sink + legacyTimestamp().size();
+  });
+  std::printf("%-12s %14s %14.1f\n", "legacy", "-", legacy_ns);
+
+  return ok ? 0 : 1;
+}
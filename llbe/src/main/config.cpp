@@ -1,5 +1,8 @@
 #include "config.hpp"
+#include "log_archive.hpp"
 #include "logger.hpp"
+#include "multicast_sink.hpp"
+#include "timestamp.hpp"
 
 #include <fstream>
 #include <iostream>
@@ -44,7 +47,7 @@ bool Config::saveToFile(const std::string &filename) const
     std::ofstream file(filename);
     if (!file.is_open())
     {
-      LOG_ERROR("Could not open config file for writing: " + filename);
+      LOG_CAT_ERROR(CONFIG, "Could not open config file for writing: " + filename);
       return false;
     }
 
@@ -55,19 +58,124 @@ bool Config::saveToFile(const std::string &filename) const
   }
   catch (const std::exception &e)
   {
-    LOG_ERROR("Error saving config: " + std::string(e.what()));
+    LOG_CAT_ERROR(CONFIG, "Error saving config: " + std::string(e.what()));
     return false;
   }
 }
 
+namespace
+{
+  bool isValidLogLevel(const std::string &level)
+  {
+    return level == "debug" || level == "info" || level == "warning" ||
+           level == "error" || level == "critical";
+  }
+}
+
 bool Config::validate() const
 {
   // Validate logging configuration
-  if (logging.level != "debug" && logging.level != "info" &&
-      logging.level != "warning" && logging.level != "error" &&
-      logging.level != "critical")
+  if (!isValidLogLevel(logging.level))
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging level: " + logging.level);
+    return false;
+  }
+
+  for (const auto &[name, level] : logging.categories)
+  {
+    Logger::Category category;
+    if (!Logger::categoryFromString(name, category))
+    {
+      LOG_CAT_ERROR(CONFIG, "Invalid logging category: " + name);
+      return false;
+    }
+    if (!isValidLogLevel(level))
+    {
+      LOG_CAT_ERROR(CONFIG, "Invalid logging level for category " + name + ": " + level);
+      return false;
+    }
+  }
+
+  llbe::TimestampFormatter::Mode timestamp_mode;
+  if (!llbe::TimestampFormatter::modeFromString(logging.timestamp, timestamp_mode))
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging timestamp mode: " + logging.timestamp);
+    return false;
+  }
+
+  if (logging.format != "text" && logging.format != "binary" && logging.format != "json")
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging format: " + logging.format);
+    return false;
+  }
+
+  if (logging.async_overflow != "drop" && logging.async_overflow != "block")
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging async_overflow: " + logging.async_overflow);
+    return false;
+  }
+
+  if (logging.async_queue_size <= 0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging async_queue_size: " + std::to_string(logging.async_queue_size));
+    return false;
+  }
+
+  if (logging.rate_limit_per_sec < 0.0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging rate_limit_per_sec: " + std::to_string(logging.rate_limit_per_sec));
+    return false;
+  }
+
+  if (logging.rate_limit_burst <= 0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging rate_limit_burst: " + std::to_string(logging.rate_limit_burst));
+    return false;
+  }
+
+  if (logging.rotate_size_mb < 0 || logging.rotate_interval_hours < 0 || logging.retain_files < 0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging rotation settings, values must not be negative");
+    return false;
+  }
+
+  if (logging.compress_rotated && !llbe::LogArchiver::compressionAvailable())
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging compress_rotated: this build has no zlib");
+    return false;
+  }
+
+  if (!isValidLogLevel(logging.flight_recorder_level))
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging flight_recorder_level: " + logging.flight_recorder_level);
+    return false;
+  }
+
+  if (logging.flight_recorder_records <= 0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging flight_recorder_records: " + std::to_string(logging.flight_recorder_records));
+    return false;
+  }
+
+  if (logging.flush_bytes < 0 || logging.flush_interval_ms < 0)
   {
-    LOG_ERROR("Invalid logging level: " + logging.level);
+    LOG_CAT_ERROR(CONFIG, "Invalid logging flush settings, values must not be negative");
+    return false;
+  }
+
+  for (const auto &group : logging.multicast)
+  {
+    llbe::MulticastSink::Group parsed;
+    if (!llbe::MulticastSink::parseGroup(group, parsed))
+    {
+      LOG_CAT_ERROR(CONFIG, "Invalid logging multicast group: " + group);
+      return false;
+    }
+  }
+
+  if (logging.multicast_ttl < 0 || logging.multicast_ttl > 255 || logging.multicast_queue <= 0)
+  {
+    LOG_CAT_ERROR(CONFIG, "Invalid logging multicast settings");
     return false;
   }
 
@@ -110,6 +218,30 @@ json Config::toJson() const
   j["logging"]["file"] = logging.file;
   j["logging"]["console_output"] = logging.console_output;
   j["logging"]["enable_file_logging"] = logging.enable_file_logging;
+  j["logging"]["async"] = logging.async;
+  j["logging"]["async_queue_size"] = logging.async_queue_size;
+  j["logging"]["async_overflow"] = logging.async_overflow;
+  j["logging"]["categories"] = logging.categories;
+  j["logging"]["timestamp"] = logging.timestamp;
+  j["logging"]["format"] = logging.format;
+  j["logging"]["rate_limit_per_sec"] = logging.rate_limit_per_sec;
+  j["logging"]["rate_limit_burst"] = logging.rate_limit_burst;
+  j["logging"]["collapse_duplicates"] = logging.collapse_duplicates;
+  j["logging"]["rotate_size_mb"] = logging.rotate_size_mb;
+  j["logging"]["rotate_interval_hours"] = logging.rotate_interval_hours;
+  j["logging"]["retain_files"] = logging.retain_files;
+  j["logging"]["compress_rotated"] = logging.compress_rotated;
+  j["logging"]["preallocate"] = logging.preallocate;
+  j["logging"]["flight_recorder"] = logging.flight_recorder;
+  j["logging"]["flight_recorder_records"] = logging.flight_recorder_records;
+  j["logging"]["flight_recorder_level"] = logging.flight_recorder_level;
+  j["logging"]["flush_bytes"] = logging.flush_bytes;
+  j["logging"]["flush_interval_ms"] = logging.flush_interval_ms;
+  j["logging"]["io_uring"] = logging.io_uring;
+  j["logging"]["sync_critical"] = logging.sync_critical;
+  j["logging"]["multicast"] = logging.multicast;
+  j["logging"]["multicast_ttl"] = logging.multicast_ttl;
+  j["logging"]["multicast_queue"] = logging.multicast_queue;
 
   // WebRTC configuration
   j["webrtc"]["stun_servers"] = webrtc.stun_servers;
@@ -142,6 +274,102 @@ void Config::loadLoggingConfig(const json &j)
   {
     logging.enable_file_logging = j["enable_file_logging"];
   }
+  if (j.contains("async"))
+  {
+    logging.async = j["async"];
+  }
+  if (j.contains("async_queue_size"))
+  {
+    logging.async_queue_size = j["async_queue_size"];
+  }
+  if (j.contains("async_overflow"))
+  {
+    logging.async_overflow = j["async_overflow"];
+  }
+  if (j.contains("categories"))
+  {
+    logging.categories = j["categories"];
+  }
+  if (j.contains("timestamp"))
+  {
+    logging.timestamp = j["timestamp"];
+  }
+  if (j.contains("format"))
+  {
+    logging.format = j["format"];
+  }
+  if (j.contains("rate_limit_per_sec"))
+  {
+    logging.rate_limit_per_sec = j["rate_limit_per_sec"];
+  }
+  if (j.contains("rate_limit_burst"))
+  {
+    logging.rate_limit_burst = j["rate_limit_burst"];
+  }
+  if (j.contains("collapse_duplicates"))
+  {
+    logging.collapse_duplicates = j["collapse_duplicates"];
+  }
+  if (j.contains("rotate_size_mb"))
+  {
+    logging.rotate_size_mb = j["rotate_size_mb"];
+  }
+  if (j.contains("rotate_interval_hours"))
+  {
+    logging.rotate_interval_hours = j["rotate_interval_hours"];
+  }
+  if (j.contains("retain_files"))
+  {
+    logging.retain_files = j["retain_files"];
+  }
+  if (j.contains("compress_rotated"))
+  {
+    logging.compress_rotated = j["compress_rotated"];
+  }
+  if (j.contains("preallocate"))
+  {
+    logging.preallocate = j["preallocate"];
+  }
+  if (j.contains("flight_recorder"))
+  {
+    logging.flight_recorder = j["flight_recorder"];
+  }
+  if (j.contains("flight_recorder_records"))
+  {
+    logging.flight_recorder_records = j["flight_recorder_records"];
+  }
+  if (j.contains("flight_recorder_level"))
+  {
+    logging.flight_recorder_level = j["flight_recorder_level"];
+  }
+  if (j.contains("flush_bytes"))
+  {
+    logging.flush_bytes = j["flush_bytes"];
+  }
+  if (j.contains("flush_interval_ms"))
+  {
+    logging.flush_interval_ms = j["flush_interval_ms"];
+  }
+  if (j.contains("io_uring"))
+  {
+    logging.io_uring = j["io_uring"];
+  }
+  if (j.contains("sync_critical"))
+  {
+    logging.sync_critical = j["sync_critical"];
+  }
+  if (j.contains("multicast"))
+  {
+    logging.multicast = j["multicast"];
+  }
+  if (j.contains("multicast_ttl"))
+  {
+    logging.multicast_ttl = j["multicast_ttl"];
+  }
+  if (j.contains("multicast_queue"))
+  {
+    logging.multicast_queue = j["multicast_queue"];
+  }
 }
 
 void Config::loadWebRTCConfig(const json &j)
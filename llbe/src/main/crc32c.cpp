@@ -0,0 +1,118 @@
+/**
+ * CRC32C (Castagnoli), the checksum used for telemetry integrity.
+ *
+ * Uses the crc32 instructions when the CPU has them (SSE4.2 on x86, the
+ * CRC extension on ARMv8), eight bytes at a time; otherwise a byte-wise
+ * table. Same target-attribute scheme as the SHA-256 kernels.
+ */
+
+#include "crypto.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace
+{
+  using Crc32cFn = uint32_t (*)(uint32_t crc, const uint8_t *data, size_t len);
+
+  constexpr uint32_t POLY = 0x82F63B78u; // reflected Castagnoli polynomial
+
+  constexpr std::array<uint32_t, 256> makeTable()
+  {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit)
+        crc = (crc >> 1) ^ (POLY & (0u - (crc & 1u)));
+      table[i] = crc;
+    }
+    return table;
+  }
+
+  constexpr std::array<uint32_t, 256> TABLE = makeTable();
+
+  uint32_t crc32cTable(uint32_t crc, const uint8_t *data, size_t len)
+  {
+    for (size_t i = 0; i < len; ++i)
+      crc = TABLE[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    return crc;
+  }
+
+#if defined(__x86_64__)
+  __attribute__((target("sse4.2")))
+  uint32_t crc32cSse42(uint32_t crc, const uint8_t *data, size_t len)
+  {
+    uint64_t crc64 = crc;
+    for (; len >= 8; len -= 8, data += 8)
+    {
+      uint64_t word;
+      std::memcpy(&word, data, 8);
+      crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; len > 0; --len, ++data)
+      crc = _mm_crc32_u8(crc, *data);
+    return crc;
+  }
+
+  Crc32cFn selectCrc32c()
+  {
+    return __builtin_cpu_supports("sse4.2") ? crc32cSse42 : crc32cTable;
+  }
+#elif defined(__aarch64__)
+#if defined(__ARM_FEATURE_CRC32)
+#define LLBE_TARGET_CRC
+#elif defined(__clang__)
+#define LLBE_TARGET_CRC __attribute__((target("crc")))
+#else
+#define LLBE_TARGET_CRC __attribute__((target("+crc")))
+#endif
+
+  LLBE_TARGET_CRC
+  uint32_t crc32cArmv8(uint32_t crc, const uint8_t *data, size_t len)
+  {
+    for (; len >= 8; len -= 8, data += 8)
+    {
+      uint64_t word;
+      std::memcpy(&word, data, 8);
+      crc = __crc32cd(crc, word);
+    }
+    for (; len > 0; --len, ++data)
+      crc = __crc32cb(crc, *data);
+    return crc;
+  }
+
+  Crc32cFn selectCrc32c()
+  {
+#if defined(__ARM_FEATURE_CRC32) || defined(__APPLE__)
+    return crc32cArmv8;
+#elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) ? crc32cArmv8 : crc32cTable;
+#else
+    return crc32cTable;
+#endif
+  }
+#else
+  Crc32cFn selectCrc32c()
+  {
+    return crc32cTable;
+  }
+#endif
+} // namespace
+
+uint32_t crypto::crc32c(const uint8_t *data, size_t len, uint32_t crc)
+{
+  static const Crc32cFn fn = selectCrc32c();
+  return ~fn(~crc, data, len);
+}
@@ -0,0 +1,163 @@
+#include "flight_recorder.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+  uint32_t currentThreadId()
+  {
+    thread_local uint32_t tid = static_cast<uint32_t>(gettid());
+    return tid;
+  }
+
+  template <typename T>
+  T readField(const char *p)
+  {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+  }
+}
+
+llbe::FlightRecorder::~FlightRecorder()
+{
+  if (header_ != nullptr)
+  {
+    // MS_ASYNC: only schedule writeback, shutdown must not wait on the disk
+    msync(header_, mapped_size_, MS_ASYNC);
+    munmap(header_, mapped_size_);
+  }
+}
+
+bool llbe::FlightRecorder::open(const std::string &path, size_t slots, uint8_t timestamp_mode)
+{
+  if (header_ != nullptr || slots == 0)
+  {
+    return false;
+  }
+
+  std::error_code ec;
+  if (std::filesystem::exists(path, ec))
+  {
+    std::filesystem::rename(path, path + ".prev", ec);
+  }
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  // Reserve the blocks now; a sparse mapping would SIGBUS on a full disk
+  size_t size = sizeof(Header) + slots * sizeof(Slot);
+  if (posix_fallocate(fd, 0, static_cast<off_t>(size)) != 0 && ftruncate(fd, static_cast<off_t>(size)) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+  {
+    return false;
+  }
+
+  // The file is zero-filled, so every slot starts out empty (seq == 0)
+  header_ = new (map) Header{};
+  std::memcpy(header_->magic, MAGIC, sizeof(MAGIC));
+  header_->version = VERSION;
+  header_->slot_size = static_cast<uint32_t>(sizeof(Slot));
+  header_->slot_count = static_cast<uint32_t>(slots);
+  header_->timestamp_mode = timestamp_mode;
+  header_->next.store(0, std::memory_order_relaxed);
+
+  slots_ = reinterpret_cast<Slot *>(static_cast<char *>(map) + sizeof(Header));
+  slot_count_ = slots;
+  mapped_size_ = size;
+  return true;
+}
+
+void llbe::FlightRecorder::record(int64_t time, uint8_t level, uint8_t category, std::string_view text)
+{
+  uint64_t seq = header_->next.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = slots_[seq % slot_count_];
+
+  // Mark the slot torn while it is rewritten; a dump taken mid-write skips it
+  slot.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size_t length = std::min(text.size(), sizeof(slot.text));
+  slot.time = time;
+  slot.thread = currentThreadId();
+  slot.level = level;
+  slot.category = category;
+  slot.length = static_cast<uint16_t>(length);
+  std::memcpy(slot.text, text.data(), length);
+
+  slot.seq.store(seq + 1, std::memory_order_release);
+}
+
+bool llbe::FlightRecorder::load(const std::string &path, Header &header, std::vector<Entry> &entries)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+  {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  if (data.size() < sizeof(Header) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+  {
+    return false;
+  }
+
+  const char *p = data.data();
+  std::memcpy(header.magic, p, sizeof(header.magic));
+  header.version = readField<uint32_t>(p + offsetof(Header, version));
+  header.slot_size = readField<uint32_t>(p + offsetof(Header, slot_size));
+  header.slot_count = readField<uint32_t>(p + offsetof(Header, slot_count));
+  header.timestamp_mode = readField<uint8_t>(p + offsetof(Header, timestamp_mode));
+
+  if (header.version != VERSION || header.slot_size != sizeof(Slot) ||
+      data.size() < sizeof(Header) + static_cast<size_t>(header.slot_count) * sizeof(Slot))
+  {
+    return false;
+  }
+
+  entries.clear();
+  for (uint32_t i = 0; i < header.slot_count; ++i)
+  {
+    const char *s = p + sizeof(Header) + static_cast<size_t>(i) * sizeof(Slot);
+    uint64_t seq = readField<uint64_t>(s + offsetof(Slot, seq));
+    uint16_t length = readField<uint16_t>(s + offsetof(Slot, length));
+    if (seq == 0 || length > sizeof(Slot::text))
+    {
+      continue;
+    }
+
+    Entry entry;
+    entry.seq = seq - 1;
+    entry.time = readField<int64_t>(s + offsetof(Slot, time));
+    entry.thread = readField<uint32_t>(s + offsetof(Slot, thread));
+    entry.level = readField<uint8_t>(s + offsetof(Slot, level));
+    entry.category = readField<uint8_t>(s + offsetof(Slot, category));
+    entry.text.assign(s + offsetof(Slot, text), length);
+    entries.push_back(std::move(entry));
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+    return a.seq < b.seq;
+  });
+  return true;
+}
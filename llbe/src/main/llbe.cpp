@@ -30,7 +30,7 @@ void llbe::LLBE::start()
 
   if (!trunk_.connect())
   {
-    LOG_ERROR("Failed to connect to backend server at " + config_->server.address);
+    LOG_CAT_ERRORF(TRUNK, "Failed to connect to backend server at {}", config_->server.address);
     running_ = false;
     return;
   }
@@ -69,7 +69,7 @@ void llbe::LLBE::handleMessageFromTrunk(rtc::message_variant& msg)
 
   if (!j["type"].is_string())
   {
-    LOG_WARNING("Received message without type from trunk: " + json_str);
+    LOG_CAT_WARNINGF(TRUNK, "Received message without type from trunk: {}", json_str);
     return;
   }
 
@@ -107,7 +107,7 @@ void llbe::LLBE::handleMessageFromTrunk(rtc::message_variant& msg)
   }
   else
   {
-    LOG_WARNING("Unknown message type from trunk: " + type);
+    LOG_CAT_WARNINGF(TRUNK, "Unknown message type from trunk: {}", type);
   }
 }
 
@@ -115,7 +115,7 @@ void llbe::LLBE::handleSdpMessage(const json& j)
 {
   // Handle SDP message from trunk
   // Handle SDP message
-  LOG_INFO("Received SDP message from trunk: " + j.dump());
+  LOG_CAT_INFOF(WEBRTC, "Received SDP message from trunk: {}", j.dump());
 
   // Recevied SDP from trunk, forwarded from browser client
   string sessionid = j.value("sessionid", "");
@@ -137,7 +137,7 @@ void llbe::LLBE::handleSdpMessage(const json& j)
     rtc::message_variant msg_var = msg_str;
     trunk_.send(msg_var);
 
-    LOG_INFO("Sent SDP answer to trunk: " + msg_str);
+    LOG_CAT_INFOF(WEBRTC, "Sent SDP answer to trunk: {}", msg_str);
   });
 
   pc->onLocalCandidate([this, sessionid](rtc::Candidate candidate) {
@@ -149,7 +149,7 @@ void llbe::LLBE::handleSdpMessage(const json& j)
       { "sdpMLineIndex", 0 } // assume single m-line, which is typical for LDC
     };
 
-    LOG_INFO("Discovered local ICE candidate: " + msg.dump());
+    LOG_CAT_INFOF(WEBRTC, "Discovered local ICE candidate: {}", msg.dump());
     rtc::message_variant msg_var = msg.dump();
     trunk_.send(msg_var);
   });
@@ -157,7 +157,7 @@ void llbe::LLBE::handleSdpMessage(const json& j)
   // Assert that sdp.sdp exists and is a string
   if (sdp.empty() || !sdp["sdp"].is_string())
   {
-    LOG_WARNING("SDP is empty in message from trunk for session " + sessionid);
+    LOG_CAT_WARNINGF(WEBRTC, "SDP is empty in message from trunk", llbe::kv("session", sessionid));
     return;
   }
 
@@ -165,7 +165,7 @@ void llbe::LLBE::handleSdpMessage(const json& j)
   pc->setRemoteDescription(rtc::Description(sdp["sdp"], rtc::Description::Type::Offer));
   pc->createAnswer();
   pc->onStateChange([this, sessionid](rtc::PeerConnection::State state) {
-    LOG_INFO("PeerConnection state for session " + sessionid + ": " + std::to_string(static_cast<int>(state)));
+    LOG_CAT_INFOF(WEBRTC, "PeerConnection state {}", state, llbe::kv("session", sessionid));
     switch (state)
     {
       case rtc::PeerConnection::State::Failed:
@@ -186,17 +186,17 @@ void llbe::LLBE::handleSdpMessage(const json& j)
       {
         it->second->close();
         session_peers_.erase(it);
-        LOG_INFO("PeerConnection for session " + sessionid + " closed and removed");
+        LOG_CAT_INFOF(WEBRTC, "PeerConnection closed and removed", llbe::kv("session", sessionid));
       }
     }
   });
 
   pc->onDataChannel([this, sessionid](std::shared_ptr<rtc::DataChannel> dc) {
-    LOG_INFO("DataChannel opened for session " + sessionid + ", label: " + dc->label());
+    LOG_CAT_INFOF(WEBRTC, "DataChannel opened, label: {}", dc->label(), llbe::kv("session", sessionid));
     std::unique_lock lck(session_datachannels_mutex_);
     if (session_datachannels_.find(sessionid) != session_datachannels_.end())
     {
-      LOG_WARNING("DataChannel for session " + sessionid + " already exists, overwriting");
+      LOG_CAT_WARNINGF(WEBRTC, "DataChannel already exists, overwriting", llbe::kv("session", sessionid));
       session_datachannels_[sessionid]->close();
     }
     session_datachannels_[sessionid] = dc;
@@ -204,13 +204,12 @@ void llbe::LLBE::handleSdpMessage(const json& j)
     dc->onMessage([sessionid](rtc::message_variant msg) {
       if (std::holds_alternative<string>(msg))
       {
-        string s = std::get<string>(msg);
-        LOG_INFO("DataChannel message from session " + sessionid + ": " + s);
+        LOG_CAT_INFOF(WEBRTC, "DataChannel message: {}", std::get<string>(msg), llbe::kv("session", sessionid));
       }
       else if (std::holds_alternative<rtc::binary>(msg))
       {
-        auto b = std::get<rtc::binary>(msg);
-        LOG_INFO("DataChannel binary message from session " + sessionid + ", size=" + std::to_string(b.size()));
+        LOG_CAT_INFOF(WEBRTC, "DataChannel binary message", llbe::kv("session", sessionid),
+          llbe::kv("size", std::get<rtc::binary>(msg).size()));
       }
     });
 
@@ -228,7 +227,7 @@ void llbe::LLBE::handleIceCandidateMessage(const json& j)
 {
   // Handle ICE candidate message from trunk
   // Handle ICE candidate message
-  LOG_INFO("Received ICE candidate message from trunk: " + j.dump());
+  LOG_CAT_INFOF(WEBRTC, "Received ICE candidate message from trunk: {}", j.dump());
 
   string sessionid = j.value("sessionid", "");
   string candidate = j.value("candidate", "");
@@ -239,13 +238,13 @@ void llbe::LLBE::handleIceCandidateMessage(const json& j)
     auto it = session_peers_.find(sessionid);
     if (it == session_peers_.end())
     {
-      LOG_WARNING("No PeerConnection found for session " + sessionid + " to add ICE candidate");
+      LOG_CAT_WARNINGF(WEBRTC, "No PeerConnection found to add ICE candidate", llbe::kv("session", sessionid));
       return;
     }
 
     rtc::Candidate ice_candidate(candidate, sdpMid);
     it->second->addRemoteCandidate(ice_candidate);
-    LOG_INFO("Added ICE candidate to PeerConnection for session " + sessionid);
+    LOG_CAT_INFOF(WEBRTC, "Added ICE candidate to PeerConnection", llbe::kv("session", sessionid));
   }
 }
 
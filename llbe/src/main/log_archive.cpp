@@ -0,0 +1,237 @@
+#include "log_archive.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef LLBE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // Suffix of files still being written by the worker
+  constexpr const char *PARTIAL_SUFFIX = ".part";
+
+  bool endsWith(const std::string &s, const std::string &suffix)
+  {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+}
+
+llbe::LogArchiver::LogArchiver(std::string log_path, size_t max_files, bool compress)
+  : log_path_(std::move(log_path)), max_files_(max_files), compress_(compress)
+{
+  worker_ = std::thread(&LogArchiver::workerLoop, this);
+}
+
+llbe::LogArchiver::~LogArchiver()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (worker_.joinable())
+  {
+    worker_.join();
+  }
+}
+
+std::string llbe::LogArchiver::nextSegmentPath() const
+{
+  return nextSegmentPath(log_path_);
+}
+
+std::string llbe::LogArchiver::nextSegmentPath(const std::string &log_path)
+{
+  std::time_t now = std::time(nullptr);
+  std::tm tm{};
+  gmtime_r(&now, &tm);
+  char stamp[32];
+  std::strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &tm);
+
+  std::string base = log_path + "." + stamp;
+  std::string path = base;
+  std::error_code ec;
+  for (int n = 1; fs::exists(path, ec) || fs::exists(path + ".gz", ec); ++n)
+  {
+    // Zero-padded so that names sort in rotation order
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "-%04d", n);
+    path = base + suffix;
+  }
+  return path;
+}
+
+void llbe::LogArchiver::submit(std::string segment_path)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.push_back(std::move(segment_path));
+  }
+  cv_.notify_one();
+}
+
+void llbe::LogArchiver::enforceRetention()
+{
+  if (max_files_ == 0)
+  {
+    return;
+  }
+
+  fs::path active(log_path_);
+  fs::path dir = active.has_parent_path() ? active.parent_path() : fs::path(".");
+  std::string prefix = active.filename().string() + ".";
+
+  struct Archive
+  {
+    std::string key; // name without ".gz", in rotation order
+    fs::path path;
+  };
+  std::vector<Archive> archives;
+
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(dir, ec))
+  {
+    std::string name = entry.path().filename().string();
+    if (name.rfind(prefix, 0) != 0 || endsWith(name, PARTIAL_SUFFIX) || !entry.is_regular_file(ec))
+    {
+      continue;
+    }
+    if (endsWith(name, ".gz"))
+    {
+      name.resize(name.size() - 3);
+    }
+    archives.push_back({name, entry.path()});
+  }
+
+  if (archives.size() <= max_files_)
+  {
+    return;
+  }
+
+  // Oldest first. Names carry the rotation time; mtimes do not, since
+  // compressing a segment rewrites it.
+  std::sort(archives.begin(), archives.end(), [](const Archive &a, const Archive &b) {
+    return a.key < b.key;
+  });
+  for (size_t i = 0; i < archives.size() - max_files_; ++i)
+  {
+    fs::remove(archives[i].path, ec);
+  }
+}
+
+bool llbe::LogArchiver::compressionAvailable()
+{
+#ifdef LLBE_HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool llbe::LogArchiver::compressFile(const std::string &src, const std::string &dst)
+{
+#ifdef LLBE_HAVE_ZLIB
+  std::ifstream in(src, std::ios::binary);
+  if (!in.is_open())
+  {
+    return false;
+  }
+
+  std::string partial = dst + PARTIAL_SUFFIX;
+  gzFile out = gzopen(partial.c_str(), "wb6");
+  if (out == nullptr)
+  {
+    return false;
+  }
+
+  char buf[64 * 1024];
+  bool ok = true;
+  while (ok && in)
+  {
+    in.read(buf, sizeof(buf));
+    std::streamsize n = in.gcount();
+    if (n > 0 && gzwrite(out, buf, static_cast<unsigned>(n)) != static_cast<int>(n))
+    {
+      ok = false;
+    }
+  }
+  ok = gzclose(out) == Z_OK && ok && !in.bad();
+
+  std::error_code ec;
+  if (ok)
+  {
+    fs::rename(partial, dst, ec);
+    ok = !ec;
+  }
+  if (!ok)
+  {
+    fs::remove(partial, ec);
+  }
+  return ok;
+#else
+  (void)src;
+  (void)dst;
+  return false;
+#endif
+}
+
+bool llbe::LogArchiver::preallocate(const std::string &path, uint64_t bytes)
+{
+  int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  bool ok = ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(bytes)) == 0;
+  ::close(fd);
+  return ok;
+}
+
+bool llbe::LogArchiver::releasePreallocated(const std::string &path)
+{
+  // Truncating to the current size frees blocks reserved past EOF
+  std::error_code ec;
+  uintmax_t size = fs::file_size(path, ec);
+  return !ec && ::truncate(path.c_str(), static_cast<off_t>(size)) == 0;
+}
+
+void llbe::LogArchiver::workerLoop()
+{
+  // Compression must never compete with the control loop
+  setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 19);
+
+  for (;;)
+  {
+    std::string segment;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+      if (pending_.empty())
+      {
+        return;
+      }
+      segment = std::move(pending_.front());
+      pending_.pop_front();
+    }
+
+    if (compress_ && compressFile(segment, segment + ".gz"))
+    {
+      std::error_code ec;
+      fs::remove(segment, ec);
+    }
+    enforceRetention();
+  }
+}
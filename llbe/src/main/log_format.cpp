@@ -0,0 +1,310 @@
+#include "log_format.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <cmath>
+
+using llbe::logfmt::ArgType;
+
+namespace
+{
+  std::atomic<const char *> formats[llbe::logfmt::MAX_FORMATS];
+  std::atomic<uint32_t> format_count{0};
+
+  template <typename T>
+  void appendNumber(std::string &out, T value)
+  {
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+  }
+
+  /**
+   * Render one encoded argument
+   * @return bytes consumed, 0 if the argument is malformed
+   */
+  size_t renderArg(std::string &out, const uint8_t *p, size_t len)
+  {
+    using llbe::logfmt::getLE;
+
+    if (len < 1)
+      return 0;
+
+    switch (static_cast<ArgType>(p[0]))
+    {
+    case ArgType::I64:
+      if (len < 9)
+        return 0;
+      appendNumber(out, getLE<int64_t>(p + 1));
+      return 9;
+    case ArgType::U64:
+      if (len < 9)
+        return 0;
+      appendNumber(out, getLE<uint64_t>(p + 1));
+      return 9;
+    case ArgType::F64:
+    {
+      if (len < 9)
+        return 0;
+      uint64_t bits = getLE<uint64_t>(p + 1);
+      double d;
+      std::memcpy(&d, &bits, sizeof(d));
+      appendNumber(out, d);
+      return 9;
+    }
+    case ArgType::STR:
+    {
+      if (len < 5)
+        return 0;
+      uint32_t n = getLE<uint32_t>(p + 1);
+      if (len - 5 < n)
+        return 0;
+      out.append(reinterpret_cast<const char *>(p + 5), n);
+      return 5 + n;
+    }
+    case ArgType::BOOL:
+      if (len < 2)
+        return 0;
+      out += p[1] ? "true" : "false";
+      return 2;
+    case ArgType::CHAR:
+      if (len < 2)
+        return 0;
+      out += static_cast<char>(p[1]);
+      return 2;
+    default:
+      return 0;
+    }
+  }
+
+  /**
+   * Render one " key=value" field. String values with spaces, quotes or
+   * '=' are quoted so the line stays machine-splittable.
+   * @return bytes consumed, 0 if the field is malformed
+   */
+  size_t renderField(std::string &out, const uint8_t *p, size_t len)
+  {
+    using llbe::logfmt::getLE;
+
+    if (len < 2 || static_cast<ArgType>(p[0]) != ArgType::KEY || len - 2 < p[1])
+      return 0;
+    size_t key_length = p[1];
+    size_t header = 2 + key_length;
+
+    out += ' ';
+    out.append(reinterpret_cast<const char *>(p + 2), key_length);
+    out += '=';
+
+    const uint8_t *value = p + header;
+    size_t rest = len - header;
+    if (rest >= 5 && static_cast<ArgType>(value[0]) == ArgType::STR)
+    {
+      uint32_t n = getLE<uint32_t>(value + 1);
+      if (rest - 5 < n)
+        return 0;
+      std::string_view text(reinterpret_cast<const char *>(value + 5), n);
+      if (text.empty() || text.find_first_of(" \"=") != std::string_view::npos)
+      {
+        out += '"';
+        for (char c : text)
+        {
+          if (c == '"' || c == '\\')
+            out += '\\';
+          out += c;
+        }
+        out += '"';
+        return header + 5 + n;
+      }
+    }
+
+    size_t used = renderArg(out, value, rest);
+    return used == 0 ? 0 : header + used;
+  }
+}
+
+uint32_t llbe::logfmt::registerFormat(const char *fmt)
+{
+  uint32_t index = format_count.fetch_add(1, std::memory_order_relaxed);
+  if (index + 1 >= MAX_FORMATS)
+  {
+    return RAW_TEXT;
+  }
+
+  formats[index + 1].store(fmt, std::memory_order_release);
+  return index + 1;
+}
+
+const char *llbe::logfmt::formatString(uint32_t id)
+{
+  if (id == RAW_TEXT || id >= MAX_FORMATS)
+  {
+    return nullptr;
+  }
+  return formats[id].load(std::memory_order_acquire);
+}
+
+void llbe::logfmt::render(std::string &out, std::string_view fmt, const uint8_t *args, size_t len)
+{
+  size_t offset = renderMessage(out, fmt, args, len);
+
+  while (offset < len && static_cast<ArgType>(args[offset]) == ArgType::KEY)
+  {
+    size_t used = renderField(out, args + offset, len - offset);
+    if (used == 0)
+      break;
+    offset += used;
+  }
+}
+
+size_t llbe::logfmt::renderMessage(std::string &out, std::string_view fmt, const uint8_t *args, size_t len)
+{
+  size_t offset = 0;
+  bool args_ok = true;
+
+  for (size_t i = 0; i < fmt.size(); ++i)
+  {
+    char c = fmt[i];
+    if (c == '{' && i + 1 < fmt.size())
+    {
+      if (fmt[i + 1] == '{')
+      {
+        out += '{';
+        ++i;
+        continue;
+      }
+      if (fmt[i + 1] == '}')
+      {
+        ++i;
+        // Fields never fill placeholders
+        bool positional = offset < len && static_cast<ArgType>(args[offset]) != ArgType::KEY;
+        size_t used = args_ok && positional ? renderArg(out, args + offset, len - offset) : 0;
+        if (used == 0)
+        {
+          // missing or malformed argument: keep the placeholder visible
+          args_ok = args_ok && !positional;
+          out += "{}";
+        }
+        offset += used;
+        continue;
+      }
+    }
+    else if (c == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}')
+    {
+      ++i;
+    }
+    out += c;
+  }
+
+  return args_ok ? offset : len;
+}
+
+void llbe::logfmt::appendJsonString(std::string &out, std::string_view text)
+{
+  static constexpr char HEX[] = "0123456789abcdef";
+
+  out += '"';
+  size_t run = 0; // start of the pending run of bytes that need no escaping
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+      continue;
+
+    out.append(text.data() + run, i - run);
+    run = i + 1;
+    switch (c)
+    {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += HEX[c >> 4];
+      out += HEX[c & 0xF];
+      break;
+    }
+  }
+  out.append(text.data() + run, text.size() - run);
+  out += '"';
+}
+
+size_t llbe::logfmt::renderJsonFields(std::string &out, const uint8_t *args, size_t len, size_t offset)
+{
+  size_t count = 0;
+  while (offset + 2 <= len && static_cast<ArgType>(args[offset]) == ArgType::KEY)
+  {
+    size_t key_length = args[offset + 1];
+    size_t header = 2 + key_length;
+    if (len - offset < header + 1)
+      break;
+
+    const uint8_t *value = args + offset + header;
+    size_t rest = len - offset - header;
+    size_t start = out.size();
+
+    out += ',';
+    appendJsonString(out, std::string_view(reinterpret_cast<const char *>(args + offset + 2), key_length));
+    out += ':';
+
+    size_t used = 0;
+    switch (static_cast<ArgType>(value[0]))
+    {
+    case ArgType::STR:
+      if (rest >= 5 && rest - 5 >= getLE<uint32_t>(value + 1))
+      {
+        uint32_t n = getLE<uint32_t>(value + 1);
+        appendJsonString(out, std::string_view(reinterpret_cast<const char *>(value + 5), n));
+        used = 5 + n;
+      }
+      break;
+    case ArgType::CHAR:
+      if (rest >= 2)
+      {
+        appendJsonString(out, std::string_view(reinterpret_cast<const char *>(value + 1), 1));
+        used = 2;
+      }
+      break;
+    case ArgType::F64:
+      if (rest >= 9)
+      {
+        uint64_t bits = getLE<uint64_t>(value + 1);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d))
+        {
+          // JSON has no NaN or infinity
+          out += "null";
+          used = 9;
+          break;
+        }
+      }
+      used = renderArg(out, value, rest);
+      break;
+    default:
+      // Integers and bools are valid JSON as rendered
+      used = renderArg(out, value, rest);
+      break;
+    }
+
+    if (used == 0)
+    {
+      out.resize(start);
+      break;
+    }
+    offset += header + used;
+    ++count;
+  }
+  return count;
+}
@@ -0,0 +1,440 @@
+#include "log_sink.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+  /**
+   * writev() until everything is written
+   * @return false on error
+   */
+  bool writeAll(int fd, const iovec *iov, int count, size_t skip)
+  {
+    int index = 0;
+    while (index < count)
+    {
+      if (skip >= iov[index].iov_len)
+      {
+        skip -= iov[index].iov_len;
+        ++index;
+        continue;
+      }
+
+      ssize_t written;
+      if (skip > 0)
+      {
+        // Finish a partly written buffer on its own; the common full write
+        // never needs a modified copy of the iovec array
+        iovec part{static_cast<char *>(iov[index].iov_base) + skip, iov[index].iov_len - skip};
+        written = ::writev(fd, &part, 1);
+      }
+      else
+      {
+        written = ::writev(fd, iov + index, std::min(count - index, IOV_MAX));
+      }
+
+      if (written < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        return false;
+      }
+      skip += static_cast<size_t>(written);
+    }
+    return true;
+  }
+}
+
+llbe::LogSink::LogSink(const Options &options) : options_(options)
+{
+}
+
+void llbe::LogSink::append(std::string &data)
+{
+  if (data.empty())
+  {
+    return;
+  }
+
+  if (staged_.empty())
+  {
+    first_staged_ = Clock::now();
+  }
+  staged_bytes_ += data.size();
+
+  staged_.emplace_back();
+  staged_.back().swap(data);
+  if (!spare_.empty())
+  {
+    data.swap(spare_.back());
+    spare_.pop_back();
+  }
+
+  if (staged_bytes_ >= options_.flush_bytes || staged_.size() >= MAX_STAGED)
+  {
+    submit();
+  }
+}
+
+bool llbe::LogSink::reap()
+{
+  if (in_flight_.empty())
+  {
+    return true;
+  }
+
+  bool ok = waitPending();
+  for (auto &buffer : in_flight_)
+  {
+    buffer.clear();
+    spare_.push_back(std::move(buffer));
+  }
+  in_flight_.clear();
+  return ok;
+}
+
+bool llbe::LogSink::flush()
+{
+  bool ok = submit();
+
+  // flush() promises the bytes are written once it returns
+  return reap() && ok;
+}
+
+bool llbe::LogSink::submit()
+{
+  // Also frees iov_ for reuse
+  bool ok = reap();
+  if (staged_.empty())
+  {
+    return ok;
+  }
+
+  iov_.clear();
+  for (auto &buffer : staged_)
+  {
+    iov_.push_back(iovec{buffer.data(), buffer.size()});
+  }
+
+  WriteResult result = writeBatch(iov_.data(), static_cast<int>(iov_.size()), staged_bytes_);
+  if (result == WriteResult::PENDING)
+  {
+    in_flight_.swap(staged_);
+  }
+  else
+  {
+    ok = ok && result == WriteResult::DONE;
+    for (auto &buffer : staged_)
+    {
+      buffer.clear();
+      spare_.push_back(std::move(buffer));
+    }
+  }
+  staged_.clear();
+  staged_bytes_ = 0;
+  return ok;
+}
+
+void llbe::LogSink::flushIfDue(Clock::time_point now)
+{
+  if (!staged_.empty() && now >= flushDeadline())
+  {
+    submit();
+  }
+}
+
+llbe::LogSink::Clock::time_point llbe::LogSink::flushDeadline() const
+{
+  if (staged_.empty())
+  {
+    return Clock::time_point::max();
+  }
+  return first_staged_ + options_.flush_interval;
+}
+
+bool llbe::LogSink::sync()
+{
+  return flush();
+}
+
+llbe::FdSink::FdSink(int fd, const Options &options) : LogSink(options), fd_(fd)
+{
+}
+
+llbe::LogSink::WriteResult llbe::FdSink::writeBatch(const iovec *iov, int count, size_t)
+{
+  if (fd_ < 0)
+  {
+    return WriteResult::FAILED;
+  }
+  return writeAll(fd_, iov, count, 0) ? WriteResult::DONE : WriteResult::FAILED;
+}
+
+#ifdef __linux__
+
+/**
+ * Minimal single-producer io_uring used for one in-flight IORING_OP_WRITEV
+ * at a time, driven through the raw syscalls (no liburing dependency).
+ */
+class llbe::FileSink::Uring
+{
+public:
+  ~Uring()
+  {
+    if (sqes_ != nullptr)
+      munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+      munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr)
+      munmap(sq_ring_, sq_ring_size_);
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  /**
+   * Set up the ring
+   * @return false if io_uring is unavailable (old kernel, seccomp)
+   */
+  bool init()
+  {
+    io_uring_params params{};
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, 4, &params));
+    if (fd_ < 0)
+    {
+      return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single)
+    {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = mapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == nullptr)
+    {
+      return false;
+    }
+    cq_ring_ = single ? sq_ring_ : mapRing(cq_ring_size_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == nullptr)
+    {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(mapRing(sqes_size_, IORING_OFF_SQES));
+    if (sqes_ == nullptr)
+    {
+      return false;
+    }
+
+    sq_head_ = field(sq_ring_, params.sq_off.head);
+    sq_tail_ = field(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *field(sq_ring_, params.sq_off.ring_mask);
+    sq_array_ = field(sq_ring_, params.sq_off.array);
+    cq_head_ = field(cq_ring_, params.cq_off.head);
+    cq_tail_ = field(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *field(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(cq_ring_) + params.cq_off.cqes);
+    return true;
+  }
+
+  /**
+   * Submit a vectored append
+   * @return false if the submission failed; the SQE is then withdrawn, so
+   *         the caller may reuse iov
+   */
+  bool submitWritev(int fd, const iovec *iov, int count)
+  {
+    uint32_t tail = std::atomic_ref<uint32_t>(*sq_tail_).load(std::memory_order_relaxed);
+    uint32_t index = tail & sq_mask_;
+
+    io_uring_sqe &sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_WRITEV;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(iov);
+    sqe.len = static_cast<uint32_t>(count);
+    // The file is O_APPEND, so the kernel writes at EOF whatever the offset.
+    // Offset -1 ("current position") does not combine safely with O_APPEND.
+    sqe.off = 0;
+    sq_array_[index] = index;
+
+    std::atomic_ref<uint32_t>(*sq_tail_).store(tail + 1, std::memory_order_release);
+    int submitted;
+    do
+    {
+      submitted = enter(1, 0, 0);
+    } while (submitted < 0 && errno == EINTR);
+    if (submitted == 1)
+    {
+      return true;
+    }
+
+    // Without SQPOLL the kernel only takes SQEs inside io_uring_enter, so
+    // the head is stable here. If it did take ours the completion will
+    // come; otherwise pull it back before the next enter picks it up with
+    // an iov the caller has since reused.
+    uint32_t head = std::atomic_ref<uint32_t>(*sq_head_).load(std::memory_order_acquire);
+    if (head == tail + 1)
+    {
+      return true;
+    }
+    std::atomic_ref<uint32_t>(*sq_tail_).store(tail, std::memory_order_release);
+    return false;
+  }
+
+  /**
+   * Wait for the completion of the submitted write
+   * @param res bytes written, or -errno from the write
+   * @return false if the completion cannot be reaped: the write may or may
+   *         not have happened, and the ring is unusable
+   */
+  bool wait(int &res)
+  {
+    for (;;)
+    {
+      uint32_t head = std::atomic_ref<uint32_t>(*cq_head_).load(std::memory_order_relaxed);
+      uint32_t tail = std::atomic_ref<uint32_t>(*cq_tail_).load(std::memory_order_acquire);
+      if (head != tail)
+      {
+        res = cqes_[head & cq_mask_].res;
+        std::atomic_ref<uint32_t>(*cq_head_).store(head + 1, std::memory_order_release);
+        return true;
+      }
+
+      if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+      {
+        return false;
+      }
+    }
+  }
+
+private:
+  int enter(unsigned submit, unsigned min_complete, unsigned flags)
+  {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd_, submit, min_complete, flags, nullptr, 0));
+  }
+
+  void *mapRing(size_t size, uint64_t offset)
+  {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+      static_cast<off_t>(offset));
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  static uint32_t *field(void *ring, uint32_t offset)
+  {
+    return reinterpret_cast<uint32_t *>(static_cast<char *>(ring) + offset);
+  }
+
+  int fd_ = -1;
+  void *sq_ring_ = nullptr;
+  void *cq_ring_ = nullptr;
+  io_uring_sqe *sqes_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  size_t cq_ring_size_ = 0;
+  size_t sqes_size_ = 0;
+
+  uint32_t *sq_head_ = nullptr;
+  uint32_t *sq_tail_ = nullptr;
+  uint32_t *sq_array_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t *cq_head_ = nullptr;
+  uint32_t *cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  io_uring_cqe *cqes_ = nullptr;
+};
+
+#else
+
+class llbe::FileSink::Uring
+{
+public:
+  bool init() { return false; }
+  bool submitWritev(int, const iovec *, int) { return false; }
+  bool wait(int &) { return false; }
+};
+
+#endif
+
+llbe::FileSink::FileSink(const std::string &path, const Options &options)
+  : FdSink(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644), options)
+{
+  if (fd_ >= 0 && options.io_uring)
+  {
+    uring_ = std::make_unique<Uring>();
+    if (!uring_->init())
+    {
+      uring_.reset();
+    }
+  }
+}
+
+llbe::FileSink::~FileSink()
+{
+  flush();
+  if (fd_ >= 0)
+  {
+    ::close(fd_);
+  }
+}
+
+bool llbe::FileSink::sync()
+{
+  bool ok = flush();
+  return fd_ >= 0 && ::fdatasync(fd_) == 0 && ok;
+}
+
+llbe::LogSink::WriteResult llbe::FileSink::writeBatch(const iovec *iov, int count, size_t bytes)
+{
+  if (uring_ && count <= IOV_MAX && uring_->submitWritev(fd_, iov, count))
+  {
+    pending_iov_ = iov;
+    pending_count_ = count;
+    pending_bytes_ = bytes;
+    return WriteResult::PENDING;
+  }
+  return FdSink::writeBatch(iov, count, bytes);
+}
+
+bool llbe::FileSink::waitPending()
+{
+  int res;
+  if (!uring_->wait(res))
+  {
+    // Outcome unknown: rewriting could duplicate the batch. Count it as
+    // failed and stop using the ring.
+    uring_.reset();
+    return false;
+  }
+  if (res < 0)
+  {
+    // The write failed as a whole (a short write reports its byte count);
+    // retry the batch the plain way
+    return writeAll(fd_, pending_iov_, pending_count_, 0);
+  }
+
+  size_t written = static_cast<size_t>(res);
+  if (written < pending_bytes_)
+  {
+    return writeAll(fd_, pending_iov_, pending_count_, written);
+  }
+  return true;
+}
@@ -1,5 +1,36 @@
 #include "logger.hpp"
 #include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <charconv>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace
+{
+  /**
+   * Per-thread buffer for text rendered on the caller's thread (flight
+   * recorder, full format registry). Keeps its capacity between calls.
+   * @return the cleared buffer
+   */
+  std::string &scratchText()
+  {
+    thread_local std::string text;
+    text.clear();
+    return text;
+  }
+
+  /**
+   * @return true if the file begins with the binary log MAGIC
+   */
+  bool startsWithMagic(const std::string &path)
+  {
+    char magic[sizeof(llbe::logfmt::MAGIC)] = {};
+    std::ifstream in(path, std::ios::binary);
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, llbe::logfmt::MAGIC, sizeof(magic)) == 0;
+  }
+}
 
 Logger &Logger::getInstance()
 {
@@ -7,12 +38,23 @@ Logger &Logger::getInstance()
   return instance;
 }
 
+Logger::Logger()
+{
+  applyLevels();
+}
+
 Logger::~Logger()
 {
   close();
 }
 
 bool Logger::initialize(const std::string &filename, Level level, bool console_output)
+{
+  return initialize(filename, level, console_output, AsyncOptions());
+}
+
+bool Logger::initialize(const std::string &filename, Level level, bool console_output,
+  const AsyncOptions &async)
 {
   std::lock_guard<std::mutex> lock(mutex_);
 
@@ -22,10 +64,13 @@ bool Logger::initialize(const std::string &filename, Level level, bool console_o
   }
 
   min_level_ = level;
+  applyLevels();
   console_output_ = console_output;
 
-  file_.open(filename, std::ios::app);
-  if (!file_.is_open())
+  // An empty filename logs to the console and added sinks only
+  filename_ = filename;
+  reopen_pending_ = false;
+  if (!filename_.empty() && !openSegment())
   {
     if (console_output_)
     {
@@ -34,11 +79,39 @@ bool Logger::initialize(const std::string &filename, Level level, bool console_o
     return false;
   }
 
+  if (console_output_)
+  {
+    stdout_sink_ = std::make_unique<llbe::FdSink>(STDOUT_FILENO, sink_options_);
+    stderr_sink_ = std::make_unique<llbe::FdSink>(STDERR_FILENO, sink_options_);
+  }
+
+  if (!filename_.empty() && (rotation_.max_bytes > 0 || rotation_.max_age.count() > 0))
+  {
+    archiver_ = std::make_unique<llbe::LogArchiver>(filename_, rotation_.max_files, rotation_.compress);
+    archiver_->enforceRetention();
+  }
+
   initialized_ = true;
 
   // Log initialization message
-  writeLog(Level::INFO, "Logger initialized - Level: " + levelToString(level) +
-    ", File: " + filename + ", Console: " + (console_output ? "yes" : "no"));
+  writeLog(Level::INFO, Category::GENERAL, "Logger initialized - Level: " + std::string(levelToString(level)) +
+    ", File: " + (filename.empty() ? "(none)" : filename) + ", Console: " + (console_output ? "yes" : "no") +
+    ", Async: " + (async.enabled ? "yes" : "no") +
+    ", Format: " + fileFormatToString(file_format_));
+
+  if (async.enabled)
+  {
+    // The ring is kept for the lifetime of the logger so that a producer racing
+    // with close() never touches freed memory.
+    if (!ring_ || ring_->capacity() < async.queue_capacity)
+    {
+      ring_ = std::make_unique<llbe::MpscRing<Record>>(async.queue_capacity);
+    }
+    overflow_ = async.overflow;
+    writer_stop_ = false;
+    writer_ = std::thread(&Logger::writerLoop, this);
+    async_ = true;
+  }
 
   return true;
 }
@@ -70,35 +143,245 @@ void Logger::critical(const std::string &message)
 
 void Logger::log(Level level, const std::string &message)
 {
+  log(level, Category::GENERAL, message);
+}
+
+void Logger::log(Level level, Category category, const std::string &message)
+{
+  if (isRecorded(level))
+  {
+    recorder_.record(timestamps_.now(), static_cast<uint8_t>(level), static_cast<uint8_t>(category), message);
+  }
+
+  // Filtered messages never touch the mutex
+  if (!isEnabled(level, category))
+  {
+    return;
+  }
+
+  logText(level, category, message);
+}
+
+void Logger::logText(Level level, Category category, const std::string &message)
+{
+  if (async_.load(std::memory_order_acquire))
+  {
+    // Async: no I/O on the caller's thread
+    enqueue(Record{level, category, timestamps_.now(), message, llbe::logfmt::RAW_TEXT, currentThreadId()});
+    syncIfCritical(level);
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
+  writeLog(level, category, message);
+}
 
-  if (level >= min_level_)
+void Logger::logEncoded(Record &&record, const char *format)
+{
+  if (record.format_id == llbe::logfmt::RAW_TEXT)
   {
-    writeLog(level, message);
+    // Registry full: render now
+    std::string &text = scratchText();
+    llbe::logfmt::render(text, format, reinterpret_cast<const uint8_t *>(record.message.data()),
+      record.message.size());
+    logText(record.level, record.category, text);
+    return;
+  }
+
+  if (async_.load(std::memory_order_acquire))
+  {
+    // Formatting is deferred to the writer thread
+    Level level = record.level;
+    enqueue(std::move(record));
+    syncIfCritical(level);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  writeRecord(record);
+}
+
+void Logger::recordFormatted(const Record &record, const char *format)
+{
+  std::string &text = scratchText();
+  llbe::logfmt::render(text, format, reinterpret_cast<const uint8_t *>(record.message.data()),
+    record.message.size());
+  recorder_.record(record.time, static_cast<uint8_t>(record.level), static_cast<uint8_t>(record.category), text);
+}
+
+bool Logger::openFlightRecorder(const std::string &path, size_t records, Level level)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!recorder_.open(path, records, static_cast<uint8_t>(timestamps_.mode())))
+  {
+    return false;
+  }
+
+  // Publishes the mapping to producers that see the new level
+  recorder_level_.store(static_cast<int>(level), std::memory_order_release);
+  return true;
+}
+
+void Logger::setLevel(Level level)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  min_level_ = level;
+  applyLevels();
+}
+
+void Logger::setCategoryLevel(Category category, Level level)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  category_overrides_[static_cast<size_t>(category)] = level;
+  category_override_mask_ |= 1u << static_cast<size_t>(category);
+  applyLevels();
+}
+
+void Logger::clearCategoryLevel(Category category)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  category_override_mask_ &= ~(1u << static_cast<size_t>(category));
+  applyLevels();
+}
+
+void Logger::applyLevels()
+{
+  for (size_t i = 0; i < static_cast<size_t>(Category::COUNT); ++i)
+  {
+    Level level = (category_override_mask_ & (1u << i)) ? category_overrides_[i] : min_level_;
+    category_levels_[i].store(static_cast<int>(level), std::memory_order_relaxed);
   }
 }
 
 void Logger::flush()
 {
+  if (async_)
+  {
+    // The writer owns the sinks; ask it to write out what it has staged
+    uint64_t target = enqueued_.load(std::memory_order_acquire);
+    uint64_t request = flush_requests_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    writer_cv_.notify_one();
+    while ((written_.load(std::memory_order_acquire) < target ||
+            flushes_done_.load(std::memory_order_acquire) < request) && async_)
+    {
+      drained_cv_.wait_for(lock, ASYNC_IDLE_WAIT);
+    }
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(mutex_);
-  if (file_.is_open())
+  if (flushRepeats(sync_out_))
   {
-    file_.flush();
+    writeOut(sync_out_);
   }
+  flushSinks();
 }
 
 void Logger::close()
 {
   std::lock_guard<std::mutex> lock(mutex_);
-  if (file_.is_open())
+  stopWriter();
+
+  if (file_sink_)
   {
-    writeLog(Level::INFO, "Logger shutting down");
-    file_.close();
+    writeLog(Level::INFO, Category::GENERAL, "Logger shutting down");
+    file_sink_.reset();
+    if (rotation_.preallocate_bytes > 0)
+    {
+      llbe::LogArchiver::releasePreallocated(filename_);
+    }
   }
+  flushSinks();
+  stdout_sink_.reset();
+  stderr_sink_.reset();
+  archiver_.reset();
+  have_last_record_ = false;
+  repeat_count_ = 0;
   initialized_ = false;
 }
 
-std::string Logger::levelToString(Level level) const
+Logger::Level Logger::levelFromString(const std::string &name, Level fallback)
+{
+  if (name == "debug")
+    return Level::DEBUG;
+  if (name == "info")
+    return Level::INFO;
+  if (name == "warning")
+    return Level::WARNING;
+  if (name == "error")
+    return Level::ERROR;
+  if (name == "critical")
+    return Level::CRITICAL;
+  return fallback;
+}
+
+Logger::OverflowPolicy Logger::overflowPolicyFromString(const std::string &name)
+{
+  return name == "block" ? OverflowPolicy::BLOCK : OverflowPolicy::DROP;
+}
+
+Logger::FileFormat Logger::fileFormatFromString(const std::string &name)
+{
+  if (name == "binary")
+    return FileFormat::BINARY;
+  if (name == "json")
+    return FileFormat::JSON;
+  return FileFormat::TEXT;
+}
+
+const char *Logger::fileFormatToString(FileFormat format)
+{
+  switch (format)
+  {
+  case FileFormat::BINARY:
+    return "binary";
+  case FileFormat::JSON:
+    return "json";
+  default:
+    return "text";
+  }
+}
+
+uint32_t Logger::currentThreadId()
+{
+  thread_local uint32_t tid = static_cast<uint32_t>(gettid());
+  return tid;
+}
+
+bool Logger::categoryFromString(const std::string &name, Category &out)
+{
+  for (size_t i = 0; i < static_cast<size_t>(Category::COUNT); ++i)
+  {
+    if (name == categoryToString(static_cast<Category>(i)))
+    {
+      out = static_cast<Category>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *Logger::categoryToString(Category category)
+{
+  switch (category)
+  {
+  case Category::GENERAL:
+    return "general";
+  case Category::TRUNK:
+    return "trunk";
+  case Category::WEBRTC:
+    return "webrtc";
+  case Category::UDP:
+    return "udp";
+  case Category::CONFIG:
+    return "config";
+  default:
+    return "unknown";
+  }
+}
+
+const char *Logger::levelToString(Level level)
 {
   switch (level)
   {
@@ -117,48 +400,586 @@ std::string Logger::levelToString(Level level) const
   }
 }
 
-std::string Logger::getCurrentTimestamp() const
+void Logger::appendTextLine(std::string &out, const llbe::TimestampFormatter &timestamps,
+  Level level, Category category, int64_t time, const char *format, std::string_view payload)
+{
+  char stamp[llbe::TimestampFormatter::MAX_LENGTH];
+  out += '[';
+  out.append(stamp, timestamps.format(time, stamp));
+  out += "] [";
+  out += levelToString(level);
+  out += "] ";
+  if (category != Category::GENERAL)
+  {
+    out += '[';
+    out += categoryToString(category);
+    out += "] ";
+  }
+  if (format)
+  {
+    llbe::logfmt::render(out, format, reinterpret_cast<const uint8_t *>(payload.data()), payload.size());
+  }
+  else
+  {
+    out += payload;
+  }
+  out += '\n';
+}
+
+void Logger::appendLine(std::string &out, const Record &record) const
+{
+  appendTextLine(out, timestamps_, record.level, record.category, record.time,
+    llbe::logfmt::formatString(record.format_id), record.message);
+}
+
+void Logger::appendBinary(std::string &out, const Record &record)
 {
-  auto now = std::chrono::system_clock::now();
-  auto time_t = std::chrono::system_clock::to_time_t(now);
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-    now.time_since_epoch()
-  ) % 1000;
+  using namespace llbe::logfmt;
 
-  std::stringstream ss;
-  ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-  ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
+  uint32_t id = record.format_id;
+  if (id != RAW_TEXT && id < defined_formats_.size() && !defined_formats_[id])
+  {
+    std::string_view format = formatString(id);
+    out.push_back(static_cast<char>(TAG_FORMAT));
+    putLE<uint32_t>(out, id);
+    putLE<uint16_t>(out, static_cast<uint16_t>(format.size()));
+    out.append(format.data(), format.size());
+    defined_formats_[id] = true;
+  }
 
-  return ss.str();
+  out.push_back(static_cast<char>(TAG_RECORD));
+  out.push_back(static_cast<char>(record.level));
+  out.push_back(static_cast<char>(record.category));
+  putLE<int64_t>(out, record.time);
+  putLE<uint32_t>(out, id);
+  putLE<uint32_t>(out, static_cast<uint32_t>(record.message.size()));
+  out += record.message;
 }
 
-void Logger::writeLog(Level level, const std::string &message)
+void Logger::appendJson(std::string &out, const Record &record)
 {
-  std::string timestamp = getCurrentTimestamp();
-  std::string level_str = levelToString(level);
+  using namespace llbe::logfmt;
 
-  std::stringstream log_entry;
-  log_entry << "[" << timestamp << "] [" << level_str << "] " << message;
+  char stamp[llbe::TimestampFormatter::MAX_LENGTH];
+  out += "{\"ts\":\"";
+  out.append(stamp, timestamps_.format(record.time, stamp));
+  out += "\",\"level\":\"";
+  out += levelToString(record.level);
+  out += "\",\"category\":\"";
+  out += categoryToString(record.category);
+  out += "\",\"thread\":";
+  char number[16];
+  out.append(number, std::to_chars(number, number + sizeof(number), record.thread).ptr);
 
-  std::string log_line = log_entry.str();
+  // Fields (e.g. "session") become members of their own, after "msg"
+  const char *format = formatString(record.format_id);
+  const auto *args = reinterpret_cast<const uint8_t *>(record.message.data());
+  size_t fields = record.message.size();
+  json_scratch_.clear();
+  if (format)
+  {
+    fields = renderMessage(json_scratch_, format, args, record.message.size());
+  }
+  else
+  {
+    json_scratch_ += record.message;
+  }
+  out += ",\"msg\":";
+  appendJsonString(out, json_scratch_);
+  if (format)
+  {
+    renderJsonFields(out, args, record.message.size(), fields);
+  }
+  out += "}\n";
+}
+
+void Logger::renderRecord(const Record &record, Output &out)
+{
+  std::string &console = record.level >= Level::ERROR ? out.console_err : out.console;
 
-  // Write to file
-  if (file_.is_open())
+  if (file_format_ != FileFormat::TEXT)
   {
-    file_ << log_line << std::endl;
-    file_.flush();
+    if (file_format_ == FileFormat::BINARY)
+    {
+      appendBinary(out.file, record);
+    }
+    else
+    {
+      appendJson(out.file, record);
+    }
+
+    // Console and added sinks still get text lines
+    if (console_output_ || !sinks_.empty())
+    {
+      size_t start = console.size();
+      appendLine(console, record);
+      if (!sinks_.empty())
+      {
+        out.text.append(console, start, std::string::npos);
+      }
+      if (!console_output_)
+      {
+        console.resize(start);
+      }
+    }
+    return;
   }
 
-  // Write to console
+  size_t start = out.file.size();
+  appendLine(out.file, record);
   if (console_output_)
   {
-    if (level >= Level::ERROR)
+    console.append(out.file, start, std::string::npos);
+  }
+  if (!sinks_.empty())
+  {
+    out.text.append(out.file, start, std::string::npos);
+  }
+}
+
+void Logger::writeLog(Level level, Category category, const std::string &message)
+{
+  writeRecord(Record{level, category, timestamps_.now(), message, llbe::logfmt::RAW_TEXT, currentThreadId()});
+}
+
+void Logger::writeRecord(const Record &record)
+{
+  emitRecord(record, sync_out_);
+  writeOut(sync_out_);
+
+  // The synchronous path has no timer to flush on, so nothing is held back
+  flushSinks(record.level == Level::CRITICAL && sync_critical_.load(std::memory_order_relaxed));
+}
+
+void Logger::writeOut(Output &out)
+{
+  if (file_sink_ && !out.file.empty())
+  {
+    segment_bytes_ += out.file.size();
+    file_sink_->append(out.file);
+    rotateIfNeeded();
+  }
+  else if (reopen_pending_)
+  {
+    rotateIfNeeded();
+  }
+
+  if (stdout_sink_)
+  {
+    stdout_sink_->append(out.console);
+  }
+  if (stderr_sink_)
+  {
+    stderr_sink_->append(out.console_err);
+  }
+
+  for (size_t i = 0; i < sinks_.size() && !out.text.empty(); ++i)
+  {
+    if (i + 1 == sinks_.size())
     {
-      std::cerr << log_line << std::endl;
+      sinks_[i]->append(out.text);
     }
     else
     {
-      std::cout << log_line << std::endl;
+      std::string copy = out.text;
+      sinks_[i]->append(copy);
     }
   }
+
+  out.file.clear();
+  out.console.clear();
+  out.console_err.clear();
+  out.text.clear();
+}
+
+void Logger::flushSinks(bool durable)
+{
+  forEachSink([](llbe::LogSink &sink) { sink.flush(); });
+  if (durable && file_sink_)
+  {
+    file_sink_->sync();
+  }
+}
+
+llbe::LogSink::Clock::time_point Logger::sinkDeadline() const
+{
+  auto deadline = llbe::LogSink::Clock::time_point::max();
+  forEachSink([&deadline](llbe::LogSink &sink) { deadline = std::min(deadline, sink.flushDeadline()); });
+  return deadline;
+}
+
+void Logger::addSink(std::unique_ptr<llbe::LogSink> sink)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  sinks_.push_back(std::move(sink));
+}
+
+void Logger::emitRecord(const Record &record, Output &out)
+{
+  if (!collapse_duplicates_.load(std::memory_order_relaxed))
+  {
+    renderRecord(record, out);
+    return;
+  }
+
+  if (have_last_record_ &&
+      record.level == last_record_.level &&
+      record.category == last_record_.category &&
+      record.format_id == last_record_.format_id &&
+      record.message == last_record_.message)
+  {
+    ++repeat_count_;
+    collapsed_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  flushRepeats(out);
+  renderRecord(record, out);
+
+  last_record_.level = record.level;
+  last_record_.category = record.category;
+  last_record_.format_id = record.format_id;
+  last_record_.message = record.message;
+  last_record_.thread = record.thread;
+  have_last_record_ = true;
+}
+
+bool Logger::flushRepeats(Output &out)
+{
+  if (repeat_count_ == 0)
+  {
+    return false;
+  }
+
+  renderRecord(Record{last_record_.level, last_record_.category, timestamps_.now(),
+    "last message repeated " + std::to_string(repeat_count_) + " times", llbe::logfmt::RAW_TEXT,
+    last_record_.thread}, out);
+  repeat_count_ = 0;
+  return true;
+}
+
+void Logger::reportSuppressed(CallSite &site, Level level, Category category)
+{
+  uint64_t count = site.suppressed.exchange(0, std::memory_order_relaxed);
+  if (count == 0)
+  {
+    return;
+  }
+
+  log(level, category, "Rate limit suppressed " + std::to_string(count) + " messages from " +
+    site.file + ":" + std::to_string(site.line));
+}
+
+Logger::Stats Logger::stats() const
+{
+  Stats stats;
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+  stats.collapsed = collapsed_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Logger::setRateLimit(double per_second, uint32_t burst)
+{
+  if (per_second <= 0.0)
+  {
+    rate_interval_ns_.store(0, std::memory_order_relaxed);
+    return;
+  }
+
+  int64_t interval = std::max<int64_t>(1, static_cast<int64_t>(1e9 / per_second));
+  rate_tolerance_ns_.store(interval * (std::max<uint32_t>(burst, 1) - 1), std::memory_order_relaxed);
+  rate_interval_ns_.store(interval, std::memory_order_relaxed);
+}
+
+void Logger::setCollapseDuplicates(bool enabled)
+{
+  collapse_duplicates_.store(enabled, std::memory_order_relaxed);
+}
+
+void Logger::enqueue(Record &&record)
+{
+  if (!ring_->tryPush(std::move(record)))
+  {
+    if (overflow_ == OverflowPolicy::DROP)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    // BLOCK: keep kicking the writer until a cell frees up
+    do
+    {
+      writer_cv_.notify_one();
+      std::this_thread::yield();
+    } while (!ring_->tryPush(std::move(record)));
+  }
+
+  enqueued_.fetch_add(1, std::memory_order_release);
+
+  // Pairs with the fence in writerLoop: either we see the writer idle and wake
+  // it, or the writer sees our record before going to sleep.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writer_idle_.load(std::memory_order_relaxed))
+  {
+    {
+      std::lock_guard<std::mutex> lock(writer_mutex_);
+    }
+    writer_cv_.notify_one();
+  }
+}
+
+void Logger::writerLoop()
+{
+  for (;;)
+  {
+    // Loaded before draining: every record logged before a flush() request
+    // is then visible to this drain
+    uint64_t requests = flush_requests_.load(std::memory_order_acquire);
+    size_t count = drainBatch();
+
+    if (count < ASYNC_BATCH_SIZE && requests != flushes_done_.load(std::memory_order_relaxed))
+    {
+      flushSinks();
+      flushes_done_.store(requests, std::memory_order_release);
+      {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+      }
+      drained_cv_.notify_all();
+    }
+    else
+    {
+      auto now = llbe::LogSink::Clock::now();
+      forEachSink([now](llbe::LogSink &sink) { sink.flushIfDue(now); });
+    }
+
+    if (count > 0)
+    {
+      continue;
+    }
+
+    if (writer_stop_)
+    {
+      flushSinks();
+      break;
+    }
+
+    // Sleep until new records, a flush() request, or the next sink deadline
+    auto wait = std::chrono::duration_cast<std::chrono::microseconds>(ASYNC_IDLE_WAIT);
+    auto deadline = sinkDeadline();
+    if (deadline != llbe::LogSink::Clock::time_point::max())
+    {
+      wait = std::clamp(std::chrono::duration_cast<std::chrono::microseconds>(
+        deadline - llbe::LogSink::Clock::now()), std::chrono::microseconds(0), wait);
+    }
+
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    writer_idle_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    writer_cv_.wait_for(lock, wait, [this]() {
+      return writer_stop_.load() || !ring_->empty() ||
+        flush_requests_.load(std::memory_order_relaxed) != flushes_done_.load(std::memory_order_relaxed);
+    });
+    writer_idle_.store(false, std::memory_order_relaxed);
+  }
+}
+
+size_t Logger::drainBatch()
+{
+  size_t count = 0;
+  bool critical = false;
+  Record record;
+  while (count < ASYNC_BATCH_SIZE && ring_->tryPop(record))
+  {
+    critical = critical || record.level == Level::CRITICAL;
+    emitRecord(record, batch_);
+    ++count;
+  }
+
+  // Idle wake-up: close out a run of repeated lines
+  bool report_repeats = count == 0 && flushRepeats(batch_);
+
+  uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+  bool report_drops = dropped != dropped_reported_;
+  if (report_drops)
+  {
+    std::string message = "Logger dropped " + std::to_string(dropped - dropped_reported_) +
+      " records (async queue full)";
+    recordEvent(Level::WARNING, message);
+    renderRecord(Record{Level::WARNING, Category::GENERAL, timestamps_.now(), message, llbe::logfmt::RAW_TEXT,
+      currentThreadId()}, batch_);
+    dropped_reported_ = dropped;
+  }
+
+  if (count == 0 && !report_drops && !report_repeats)
+  {
+    // Let an idle segment still rotate on age
+    rotateIfNeeded();
+    return 0;
+  }
+
+  // Staged as one buffer per sink; written with one writev per flush
+  writeOut(batch_);
+  if (critical && sync_critical_.load(std::memory_order_relaxed))
+  {
+    flushSinks(true);
+  }
+
+  written_.fetch_add(count, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+  }
+  drained_cv_.notify_all();
+
+  return count;
+}
+
+bool Logger::openSegment()
+{
+  std::error_code ec;
+  uintmax_t existing = std::filesystem::file_size(filename_, ec);
+  if (ec)
+  {
+    existing = 0;
+  }
+
+  if (file_format_ == FileFormat::BINARY && existing > 0 && !startsWithMagic(filename_))
+  {
+    // A text/JSON log from an earlier run: appending binary records would
+    // leave a file logdecode rejects, so move it aside and start fresh
+    std::string aside = llbe::LogArchiver::nextSegmentPath(filename_);
+    std::filesystem::rename(filename_, aside, ec);
+    if (ec)
+    {
+      std::cerr << "Failed to move non-binary log " << filename_ << " aside: " << ec.message() << std::endl;
+      return false;
+    }
+    std::cerr << "Moved non-binary log " << filename_ << " to " << aside << std::endl;
+    existing = 0;
+  }
+
+  file_sink_ = std::make_unique<llbe::FileSink>(filename_, sink_options_);
+  if (!file_sink_->isOpen())
+  {
+    file_sink_.reset();
+    return false;
+  }
+
+  // Reserve the segment up front so appends never allocate extents
+  if (rotation_.preallocate_bytes > existing)
+  {
+    llbe::LogArchiver::preallocate(filename_, rotation_.preallocate_bytes);
+  }
+
+  segment_bytes_ = existing;
+  segment_opened_ = std::chrono::steady_clock::now();
+
+  if (file_format_ == FileFormat::BINARY)
+  {
+    // Format ids are per process, so every session and segment redefines what it uses
+    std::string header;
+    if (existing == 0)
+    {
+      header.append(llbe::logfmt::MAGIC, sizeof(llbe::logfmt::MAGIC));
+    }
+    header.push_back(static_cast<char>(llbe::logfmt::TAG_SESSION));
+    header.push_back(static_cast<char>(llbe::logfmt::BINARY_VERSION));
+    header.push_back(static_cast<char>(timestamps_.mode()));
+    segment_bytes_ += header.size();
+    file_sink_->append(header);
+    defined_formats_.assign(llbe::logfmt::MAX_FORMATS, false);
+  }
+
+  return true;
+}
+
+void Logger::rotateIfNeeded()
+{
+  if (reopen_pending_)
+  {
+    // The last rotation could not open a new file; records since are lost
+    if (openSegment())
+    {
+      reopen_pending_ = false;
+      recordEvent(Level::WARNING, "Log file reopened after a failed rotation");
+    }
+    return;
+  }
+
+  if (!archiver_ || segment_bytes_ == 0)
+  {
+    return;
+  }
+
+  bool full = rotation_.max_bytes > 0 && segment_bytes_ >= rotation_.max_bytes;
+  bool expired = rotation_.max_age.count() > 0 &&
+    std::chrono::steady_clock::now() - segment_opened_ >= rotation_.max_age;
+  if (!full && !expired)
+  {
+    return;
+  }
+
+  file_sink_.reset();
+  if (rotation_.preallocate_bytes > 0)
+  {
+    llbe::LogArchiver::releasePreallocated(filename_);
+  }
+
+  std::string segment = archiver_->nextSegmentPath();
+  std::error_code ec;
+  std::filesystem::rename(filename_, segment, ec);
+  if (ec)
+  {
+    std::cerr << "Failed to rotate log file " << filename_ << ": " << ec.message() << std::endl;
+  }
+  else
+  {
+    // Archived whether or not a new file can be opened
+    archiver_->submit(segment);
+  }
+
+  if (!openSegment())
+  {
+    std::cerr << "Failed to reopen log file after rotation: " << filename_ << ", retrying on the next record"
+              << std::endl;
+    reopen_pending_ = true;
+    return;
+  }
+
+  if (ec)
+  {
+    // Keep appending to the old file; try again after another full segment
+    segment_bytes_ = 0;
+    return;
+  }
+  recordEvent(Level::INFO, "Log rotated to " + segment);
+}
+
+void Logger::recordEvent(Level level, const std::string &message)
+{
+  if (isRecorded(level))
+  {
+    recorder_.record(timestamps_.now(), static_cast<uint8_t>(level),
+      static_cast<uint8_t>(Category::GENERAL), message);
+  }
+}
+
+void Logger::stopWriter()
+{
+  if (!async_.exchange(false))
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    writer_stop_ = true;
+  }
+  writer_cv_.notify_one();
+  drained_cv_.notify_all();
+
+  if (writer_.joinable())
+  {
+    writer_.join();
+  }
 }
@@ -2,12 +2,14 @@
 #include <memory>
 #include <csignal>
 #include <string>
+#include <vector>
 #include <getopt.h>
 
 #include <rtc/rtc.hpp>
 
 #include "config.hpp"
 #include "logger.hpp"
+#include "multicast_sink.hpp"
 #include "llbe.hpp"
 
 namespace
@@ -84,25 +86,73 @@ int main(int argc, char *argv[])
   }
 
   // Initialize logger
-  Logger::Level log_level = Logger::Level::INFO;
-  if (config->logging.level == "debug")
-    log_level = Logger::Level::DEBUG;
-  else if (config->logging.level == "warning")
-    log_level = Logger::Level::WARNING;
-  else if (config->logging.level == "error")
-    log_level = Logger::Level::ERROR;
-  else if (config->logging.level == "critical")
-    log_level = Logger::Level::CRITICAL;
+  Logger::Level log_level = Logger::levelFromString(config->logging.level);
+
+  Logger::AsyncOptions log_async;
+  log_async.enabled = config->logging.async;
+  log_async.queue_capacity = static_cast<size_t>(config->logging.async_queue_size);
+  log_async.overflow = Logger::overflowPolicyFromString(config->logging.async_overflow);
+
+  llbe::TimestampFormatter::Mode timestamp_mode = llbe::TimestampFormatter::Mode::LOCAL;
+  llbe::TimestampFormatter::modeFromString(config->logging.timestamp, timestamp_mode);
+  Logger::getInstance().setTimestampMode(timestamp_mode);
+  Logger::getInstance().setFileFormat(Logger::fileFormatFromString(config->logging.format));
+  Logger::getInstance().setRateLimit(config->logging.rate_limit_per_sec,
+    static_cast<uint32_t>(config->logging.rate_limit_burst));
+  Logger::getInstance().setCollapseDuplicates(config->logging.collapse_duplicates);
+
+  Logger::RotationOptions log_rotation;
+  log_rotation.max_bytes = static_cast<uint64_t>(config->logging.rotate_size_mb) * 1024 * 1024;
+  log_rotation.max_age = std::chrono::hours(config->logging.rotate_interval_hours);
+  log_rotation.preallocate_bytes = config->logging.preallocate ? log_rotation.max_bytes : 0;
+  log_rotation.max_files = static_cast<size_t>(config->logging.retain_files);
+  log_rotation.compress = config->logging.compress_rotated;
+  Logger::getInstance().setRotation(log_rotation);
+
+  llbe::LogSink::Options log_sinks;
+  log_sinks.flush_bytes = static_cast<size_t>(config->logging.flush_bytes);
+  log_sinks.flush_interval = std::chrono::milliseconds(config->logging.flush_interval_ms);
+  log_sinks.io_uring = config->logging.io_uring;
+  Logger::getInstance().setSinkOptions(log_sinks);
+  Logger::getInstance().setSyncCritical(config->logging.sync_critical);
+
+  if (!config->logging.multicast.empty())
+  {
+    std::vector<llbe::MulticastSink::Group> groups;
+    for (const auto &spec : config->logging.multicast)
+    {
+      llbe::MulticastSink::Group group;
+      if (llbe::MulticastSink::parseGroup(spec, group))
+        groups.push_back(group);
+    }
+    Logger::getInstance().addSink(std::make_unique<llbe::MulticastSink>(groups,
+      static_cast<size_t>(config->logging.multicast_queue), config->logging.multicast_ttl, log_sinks));
+  }
 
   if (config->logging.enable_file_logging)
   {
-    if (!Logger::getInstance().initialize(config->logging.file, log_level, config->logging.console_output))
+    if (!Logger::getInstance().initialize(config->logging.file, log_level, config->logging.console_output, log_async))
     {
       std::cerr << "Failed to initialize logger" << std::endl;
       return 1;
     }
   }
 
+  if (!config->logging.flight_recorder.empty() &&
+      !Logger::getInstance().openFlightRecorder(config->logging.flight_recorder,
+        static_cast<size_t>(config->logging.flight_recorder_records),
+        Logger::levelFromString(config->logging.flight_recorder_level)))
+  {
+    std::cerr << "Failed to open flight recorder: " << config->logging.flight_recorder << std::endl;
+  }
+
+  for (const auto &[name, level] : config->logging.categories)
+  {
+    Logger::Category category;
+    if (Logger::categoryFromString(name, category))
+      Logger::getInstance().setCategoryLevel(category, Logger::levelFromString(level));
+  }
+
   LOG_INFO("Starting Telepresence LLBE v1.0.0");
   LOG_INFO("Configuration loaded from: " + config_file);
 
@@ -0,0 +1,195 @@
+#include "multicast_sink.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <string_view>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+  // Lines handed to one sendmmsg() call, per group
+  constexpr size_t SEND_BATCH = 64;
+}
+
+llbe::MulticastSink::MulticastSink(const std::vector<Group> &groups, size_t queue_lines, int ttl,
+  const Options &options)
+  : LogSink(options), queue_(std::max<size_t>(queue_lines, 1))
+{
+  for (const auto &group : groups)
+  {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(group.port);
+    if (inet_pton(AF_INET, group.address.c_str(), &addr.sin_addr) == 1)
+    {
+      destinations_.push_back(addr);
+    }
+  }
+
+  if (destinations_.empty())
+  {
+    return;
+  }
+
+  sock_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (sock_ < 0)
+  {
+    return;
+  }
+
+  unsigned char mttl = static_cast<unsigned char>(std::clamp(ttl, 0, 255));
+  setsockopt(sock_, IPPROTO_IP, IP_MULTICAST_TTL, &mttl, sizeof(mttl));
+
+  sender_ = std::thread(&MulticastSink::senderLoop, this);
+}
+
+llbe::MulticastSink::~MulticastSink()
+{
+  // Queue what is still staged; the sender drains the queue before exiting
+  flush();
+
+  if (sender_.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    sender_.join();
+  }
+
+  if (sock_ >= 0)
+  {
+    ::close(sock_);
+  }
+}
+
+bool llbe::MulticastSink::parseGroup(const std::string &spec, Group &out)
+{
+  auto colon = spec.find(':');
+  out.address = spec.substr(0, colon);
+  out.port = 12345;
+  if (colon == std::string::npos)
+  {
+    return !out.address.empty();
+  }
+
+  unsigned port = 0;
+  const char *begin = spec.data() + colon + 1;
+  const char *end = spec.data() + spec.size();
+  auto [ptr, ec] = std::from_chars(begin, end, port);
+  if (ec != std::errc() || ptr != end || port == 0 || port > 65535)
+  {
+    return false;
+  }
+  out.port = static_cast<uint16_t>(port);
+  return !out.address.empty();
+}
+
+llbe::LogSink::WriteResult llbe::MulticastSink::writeBatch(const iovec *iov, int count, size_t)
+{
+  if (!isOpen())
+  {
+    return WriteResult::FAILED;
+  }
+
+  // One datagram per line, without the newline, as loglistener prints it
+  for (int i = 0; i < count; ++i)
+  {
+    std::string_view data(static_cast<const char *>(iov[i].iov_base), iov[i].iov_len);
+    while (!data.empty())
+    {
+      size_t eol = data.find('\n');
+      std::string_view line = data.substr(0, eol);
+      data.remove_prefix(eol == std::string_view::npos ? data.size() : eol + 1);
+
+      if (line.empty())
+      {
+        continue;
+      }
+      if (!queue_.tryPush(std::string(line.substr(0, MAX_DATAGRAM))))
+      {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Taking the lock orders the pushes before the sender's emptiness check
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  cv_.notify_one();
+  return WriteResult::DONE;
+}
+
+void llbe::MulticastSink::senderLoop()
+{
+  std::vector<std::string> lines;
+  lines.reserve(SEND_BATCH);
+
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (stop_ && queue_.empty())
+      {
+        return;
+      }
+    }
+
+    lines.clear();
+    std::string line;
+    while (lines.size() < SEND_BATCH && queue_.tryPop(line))
+    {
+      lines.push_back(std::move(line));
+    }
+    sendLines(lines);
+  }
+}
+
+void llbe::MulticastSink::sendLines(const std::vector<std::string> &lines)
+{
+  std::vector<iovec> iov(lines.size());
+  std::vector<mmsghdr> msgs(lines.size() * destinations_.size());
+
+  size_t m = 0;
+  for (size_t i = 0; i < lines.size(); ++i)
+  {
+    iov[i] = iovec{const_cast<char *>(lines[i].data()), lines[i].size()};
+    for (auto &dest : destinations_)
+    {
+      msghdr &hdr = msgs[m++].msg_hdr;
+      hdr.msg_name = &dest;
+      hdr.msg_namelen = sizeof(dest);
+      hdr.msg_iov = &iov[i];
+      hdr.msg_iovlen = 1;
+    }
+  }
+
+  size_t sent = 0;
+  while (sent < msgs.size())
+  {
+    int n = ::sendmmsg(sock_, msgs.data() + sent, static_cast<unsigned>(msgs.size() - sent), MSG_DONTWAIT);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+      {
+        // Socket buffer full: drop the rest rather than wait
+        dropped_.fetch_add(msgs.size() - sent, std::memory_order_relaxed);
+        return;
+      }
+      // Skip a datagram the kernel refuses (e.g. unreachable group)
+      n = 1;
+    }
+    sent += static_cast<size_t>(n);
+  }
+}
@@ -3,41 +3,25 @@
  * 
  * Note: this is meant to use mbedTLS. The SHA256 implementation was LLM-generated
  * so might be a bit buggy. Switch to a well-known implementation if mbedTLS is dropped.
+ *
+ * Without mbedTLS the compression runs on the fastest kernel the CPU offers
+ * (see sha256_backend.hpp); the scalar loop below is the fallback and the
+ * reference the accelerated kernels are tested against. crypto::Sha256 and
+ * the iovec overload always use these kernels.
  */
 
+#include "crypto.hpp"
+#include "sha256_backend.hpp"
+
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 
 #ifdef HAVE_MBEDTLS
 #include <mbedtls/sha256.h>
 #endif
 
-extern void sha256_hash(const uint8_t *data, int len, uint8_t out[32]);
-extern bool sha256_verify(const uint8_t *data, int len, const uint8_t expected[32]);
-
-#ifdef HAVE_MBEDTLS
-void sha256_hash(const uint8_t *data, int len, uint8_t out[32])
-{
-#if defined(MBEDTLS_SHA256_ALT) || !defined(MBEDTLS_SHA256_C)
-    // If the one-shot convenience API isn't available, fall back to starts/update/finish
-    mbedtls_sha256_context ctx;
-    mbedtls_sha256_init(&ctx);
-    mbedtls_sha256_starts_ret(&ctx, 0); // 0 = SHA-256, not SHA-224
-    mbedtls_sha256_update_ret(&ctx, data, static_cast<size_t>(len));
-    mbedtls_sha256_finish_ret(&ctx, out);
-    mbedtls_sha256_free(&ctx);
-#else
-    // Use the one-shot API which is simpler and avoids per-call init/free overhead
-    // mbedtls_sha256_ret returns 0 on success
-    mbedtls_sha256_ret(reinterpret_cast<const unsigned char*>(data), static_cast<size_t>(len), out, 0);
-#endif
-}
-#else
-// builtin fallback (stable reference-like implementation)
-#include <vector>
-#include <cstdint>
-#include <cstring>
-
 namespace
 {
   inline uint32_t rotr(uint32_t x, unsigned n) { return (x >> n) | (x << (32 - n)); }
@@ -48,60 +32,100 @@ namespace
   inline uint32_t ssig0(uint32_t x) { return rotr(x, 7) ^ rotr(x, 18) ^ (x >> 3); }
   inline uint32_t ssig1(uint32_t x) { return rotr(x, 17) ^ rotr(x, 19) ^ (x >> 10); }
 
-  const uint32_t K[64] = {
-      0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
-      0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
-      0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
-      0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
-      0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
-      0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
-      0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
-      0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u};
-
-  // constant-time memory compare
-  bool ct_equal(const uint8_t *a, const uint8_t *b, size_t n)
+  bool alwaysSupported() { return true; }
+
+  const crypto::sha256::Backend BACKENDS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"sha-ni", crypto::sha256::blocksShaNi, crypto::sha256::cpuHasShaNi},
+#endif
+#if defined(__aarch64__) && defined(LLBE_SHA256_ARMV8)
+    {"armv8", crypto::sha256::blocksArmv8, crypto::sha256::cpuHasArmv8Sha2},
+#endif
+    {"scalar", crypto::sha256::blocksScalar, alwaysSupported},
+  };
+
+  const crypto::sha256::Backend &selectBackend()
   {
-    uint8_t diff = 0;
-    for (size_t i = 0; i < n; ++i)
-      diff |= a[i] ^ b[i];
-    return diff == 0;
+    for (const auto &backend : BACKENDS)
+    {
+      if (backend.supported())
+        return backend;
+    }
+    return BACKENDS[std::size(BACKENDS) - 1];
+  }
+
+  // Single-lane batch backend around a one-message kernel
+  template <crypto::sha256::BlockFn Blocks>
+  void serialLane(const uint8_t *const data[], const size_t len[], uint8_t out[][32])
+  {
+    crypto::Sha256 ctx(Blocks);
+    ctx.update(data[0], len[0]);
+    ctx.final(out[0]);
   }
 
+  // Ordered by measured throughput on 16 B..2304 B messages: 16 AVX-512
+  // lanes are about twice SHA-NI, 8 AVX2 lanes about level with it
+  const crypto::sha256::BatchBackend BATCH_BACKENDS[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    {"avx512x16", 16, crypto::sha256::hashLanes16Avx512, crypto::sha256::cpuHasAvx512},
+    {"sha-ni", 1, serialLane<crypto::sha256::blocksShaNi>, crypto::sha256::cpuHasShaNi},
+    {"avx2x8", 8, crypto::sha256::hashLanes8Avx2, crypto::sha256::cpuHasAvx2},
+#endif
+#if defined(__aarch64__) && defined(LLBE_SHA256_ARMV8)
+    {"armv8", 1, serialLane<crypto::sha256::blocksArmv8>, crypto::sha256::cpuHasArmv8Sha2},
+#endif
+    {"simdx4", 4, crypto::sha256::hashLanes4, alwaysSupported},
+    {"scalar", 1, serialLane<crypto::sha256::blocksScalar>, alwaysSupported},
+  };
+
+  const crypto::sha256::BatchBackend &selectBatchBackend()
+  {
+    for (const auto &backend : BATCH_BACKENDS)
+    {
+      if (backend.supported())
+        return backend;
+    }
+    return BATCH_BACKENDS[std::size(BATCH_BACKENDS) - 1];
+  }
 } // namespace
 
-void sha256_hash(const uint8_t *data, int len, uint8_t out[32])
+alignas(16) const uint32_t crypto::sha256::K[64] = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u, 0xab1c5ed5u,
+    0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u,
+    0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+    0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u,
+    0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u,
+    0xa2bfe8a1u, 0xa81a664bu, 0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+    0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u};
+
+std::span<const crypto::sha256::Backend> crypto::sha256::backends()
 {
-  // Initial hash values
-  uint32_t h[8] = {
-      0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
-      0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u};
+  return BACKENDS;
+}
+
+const crypto::sha256::Backend &crypto::sha256::active()
+{
+  static const Backend &backend = selectBackend();
+  return backend;
+}
+
+std::span<const crypto::sha256::BatchBackend> crypto::sha256::batchBackends()
+{
+  return BATCH_BACKENDS;
+}
+
+const crypto::sha256::BatchBackend &crypto::sha256::activeBatch()
+{
+  static const BatchBackend &backend = selectBatchBackend();
+  return backend;
+}
 
-  // Pre-processing: padding
-  uint64_t bitlen = static_cast<uint64_t>(len) * 8ULL;
-
-  // Compute padded length: original + 1 (0x80) + padding + 8 (length) = multiple of 64
-  size_t pad_len = 1 + 8; // at least
-  size_t rem = (len + 1 + 8) % 64;
-  if (rem != 0)
-    pad_len += (64 - rem);
-
-  size_t total = static_cast<size_t>(len) + pad_len;
-  std::vector<uint8_t> buf;
-  buf.reserve(total);
-  buf.insert(buf.end(), data, data + len);
-  buf.push_back(0x80);
-  if (pad_len > 1)
-    buf.insert(buf.end(), pad_len - 1 - 8, 0x00);
-
-  // append length in bits as big-endian 64-bit
-  for (int i = 7; i >= 0; --i)
-    buf.push_back(static_cast<uint8_t>((bitlen >> (8 * i)) & 0xFFu));
-
-  // Process each 512-bit chunk
-  size_t chunks = buf.size() / 64;
-  for (size_t c = 0; c < chunks; ++c)
+void crypto::sha256::blocksScalar(uint32_t state[8], const uint8_t *blocks, size_t n)
+{
+  for (size_t c = 0; c < n; ++c)
   {
-    const uint8_t *chunk = buf.data() + c * 64;
+    const uint8_t *chunk = blocks + c * 64;
     uint32_t w[64];
     for (int i = 0; i < 16; ++i)
     {
@@ -113,14 +137,14 @@ void sha256_hash(const uint8_t *data, int len, uint8_t out[32])
     for (int i = 16; i < 64; ++i)
       w[i] = ssig1(w[i - 2]) + w[i - 7] + ssig0(w[i - 15]) + w[i - 16];
 
-    uint32_t a = h[0];
-    uint32_t b = h[1];
-    uint32_t c2 = h[2];
-    uint32_t d = h[3];
-    uint32_t e = h[4];
-    uint32_t f = h[5];
-    uint32_t g = h[6];
-    uint32_t hh = h[7];
+    uint32_t a = state[0];
+    uint32_t b = state[1];
+    uint32_t c2 = state[2];
+    uint32_t d = state[3];
+    uint32_t e = state[4];
+    uint32_t f = state[5];
+    uint32_t g = state[6];
+    uint32_t hh = state[7];
 
     for (int t = 0; t < 64; ++t)
     {
@@ -136,30 +160,208 @@ void sha256_hash(const uint8_t *data, int len, uint8_t out[32])
       a = T1 + T2;
     }
 
-    h[0] += a;
-    h[1] += b;
-    h[2] += c2;
-    h[3] += d;
-    h[4] += e;
-    h[5] += f;
-    h[6] += g;
-    h[7] += hh;
+    state[0] += a;
+    state[1] += b;
+    state[2] += c2;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += hh;
   }
+}
+
+crypto::Sha256::Sha256() : Sha256(sha256::active().blocks)
+{
+}
+
+crypto::Sha256::Sha256(BlockFn blocks) : blocks_(blocks)
+{
+  init();
+}
+
+void crypto::Sha256::init()
+{
+  // Initial hash values
+  static constexpr uint32_t H0[8] = {
+      0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+      0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u};
+  std::memcpy(state_, H0, sizeof(state_));
+  length_ = 0;
+  buffered_ = 0;
+}
+
+void crypto::Sha256::update(const uint8_t *data, size_t len)
+{
+  length_ += len;
+
+  // Top up a partial block first
+  if (buffered_ > 0)
+  {
+    size_t take = std::min(len, sizeof(buffer_) - buffered_);
+    std::memcpy(buffer_ + buffered_, data, take);
+    buffered_ += take;
+    data += take;
+    len -= take;
+    if (buffered_ < sizeof(buffer_))
+      return;
+    blocks_(state_, buffer_, 1);
+    buffered_ = 0;
+  }
+
+  // Whole blocks straight from the caller's buffer
+  if (size_t n = len / 64; n > 0)
+  {
+    blocks_(state_, data, n);
+    data += n * 64;
+    len -= n * 64;
+  }
+
+  if (len > 0)
+  {
+    std::memcpy(buffer_, data, len);
+    buffered_ = len;
+  }
+}
+
+void crypto::Sha256::final(uint8_t out[32])
+{
+  uint64_t bitlen = length_ * 8ULL;
+
+  // 0x80, zeros, then the 64-bit big-endian bit length; spills into a
+  // second block when fewer than 9 bytes are free
+  buffer_[buffered_++] = 0x80;
+  if (buffered_ > 56)
+  {
+    std::memset(buffer_ + buffered_, 0, sizeof(buffer_) - buffered_);
+    blocks_(state_, buffer_, 1);
+    buffered_ = 0;
+  }
+  std::memset(buffer_ + buffered_, 0, 56 - buffered_);
+  for (int i = 0; i < 8; ++i)
+    buffer_[56 + i] = static_cast<uint8_t>((bitlen >> (8 * (7 - i))) & 0xFFu);
+  blocks_(state_, buffer_, 1);
 
   // Produce the final hash value (big-endian)
   for (int i = 0; i < 8; ++i)
   {
-    out[i * 4 + 0] = static_cast<uint8_t>((h[i] >> 24) & 0xFFu);
-    out[i * 4 + 1] = static_cast<uint8_t>((h[i] >> 16) & 0xFFu);
-    out[i * 4 + 2] = static_cast<uint8_t>((h[i] >> 8) & 0xFFu);
-    out[i * 4 + 3] = static_cast<uint8_t>((h[i] >> 0) & 0xFFu);
+    out[i * 4 + 0] = static_cast<uint8_t>((state_[i] >> 24) & 0xFFu);
+    out[i * 4 + 1] = static_cast<uint8_t>((state_[i] >> 16) & 0xFFu);
+    out[i * 4 + 2] = static_cast<uint8_t>((state_[i] >> 8) & 0xFFu);
+    out[i * 4 + 3] = static_cast<uint8_t>((state_[i] >> 0) & 0xFFu);
+  }
+
+  init();
+}
+
+void crypto::sha256::hash(const Backend &backend, const uint8_t *data, size_t len, uint8_t out[32])
+{
+  Sha256 ctx(backend.blocks);
+  ctx.update(data, len);
+  ctx.final(out);
+}
+
+void crypto::sha256::hashBatch(const BatchBackend &backend, const uint8_t *const data[], const size_t len[], uint8_t out[][32], size_t count)
+{
+  static const uint8_t EMPTY = 0;
+  size_t i = 0;
+  for (; i + backend.lanes <= count; i += backend.lanes)
+    backend.hash(data + i, len + i, out + i);
+  if (i == count)
+    return;
+
+  // A short remainder still costs a full vector; below a quarter of the
+  // lanes the single-message kernel is cheaper
+  size_t rest = count - i;
+  if (rest * 4 < backend.lanes)
+  {
+    for (; i < count; ++i)
+      hash(active(), data[i], len[i], out[i]);
+    return;
   }
+
+  const uint8_t *lane_data[MAX_LANES];
+  size_t lane_len[MAX_LANES];
+  uint8_t lane_out[MAX_LANES][32];
+  for (size_t j = 0; j < backend.lanes; ++j)
+  {
+    lane_data[j] = j < rest ? data[i + j] : &EMPTY;
+    lane_len[j] = j < rest ? len[i + j] : 0;
+  }
+  backend.hash(lane_data, lane_len, lane_out);
+  std::memcpy(out + i, lane_out, rest * 32);
+}
+
+void crypto::sha256_hash(const struct iovec *iov, int iovcnt, uint8_t out[32])
+{
+  Sha256 ctx;
+  for (int i = 0; i < iovcnt; ++i)
+    ctx.update(static_cast<const uint8_t *>(iov[i].iov_base), iov[i].iov_len);
+  ctx.final(out);
 }
 
-bool sha256_verify(const uint8_t *data, int len, const uint8_t expected[32])
+#ifdef HAVE_MBEDTLS
+void crypto::sha256_hash(const uint8_t *data, int len, uint8_t out[32])
+{
+#if defined(MBEDTLS_SHA256_ALT) || !defined(MBEDTLS_SHA256_C)
+    // If the one-shot convenience API isn't available, fall back to starts/update/finish
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0); // 0 = SHA-256, not SHA-224
+    mbedtls_sha256_update_ret(&ctx, data, static_cast<size_t>(len));
+    mbedtls_sha256_finish_ret(&ctx, out);
+    mbedtls_sha256_free(&ctx);
+#else
+    // Use the one-shot API which is simpler and avoids per-call init/free overhead
+    // mbedtls_sha256_ret returns 0 on success
+    mbedtls_sha256_ret(reinterpret_cast<const unsigned char*>(data), static_cast<size_t>(len), out, 0);
+#endif
+}
+#else
+void crypto::sha256_hash(const uint8_t *data, int len, uint8_t out[32])
+{
+  sha256::hash(sha256::active(), data, static_cast<size_t>(len), out);
+}
+#endif
+
+bool crypto::ct_equal(const uint8_t *a, const uint8_t *b, size_t n)
+{
+  uint8_t diff = 0;
+  for (size_t i = 0; i < n; ++i)
+    diff |= a[i] ^ b[i];
+  return diff == 0;
+}
+
+bool crypto::sha256_verify(const uint8_t *data, int len, const uint8_t expected[32])
 {
   uint8_t out[32];
   sha256_hash(data, len, out);
   return ct_equal(out, expected, 32);
 }
-#endif
+
+uint64_t crypto::sha256_verify_batch(const Sha256VerifyJob *jobs, int count)
+{
+  const sha256::BatchBackend &backend = sha256::activeBatch();
+  uint64_t valid = 0;
+
+  // Chunks of MAX_LANES keep the scratch arrays on the stack
+  for (int base = 0; base < count && base < 64; base += static_cast<int>(sha256::MAX_LANES))
+  {
+    size_t n = static_cast<size_t>(std::min({count, 64, base + static_cast<int>(sha256::MAX_LANES)}) - base);
+    const uint8_t *data[sha256::MAX_LANES];
+    size_t len[sha256::MAX_LANES];
+    uint8_t out[sha256::MAX_LANES][32];
+    for (size_t j = 0; j < n; ++j)
+    {
+      data[j] = jobs[base + j].data;
+      len[j] = static_cast<size_t>(std::max(jobs[base + j].len, 0));
+    }
+    sha256::hashBatch(backend, data, len, out, n);
+    for (size_t j = 0; j < n; ++j)
+    {
+      if (jobs[base + j].len >= 0 && ct_equal(out[j], jobs[base + j].expected, 32))
+        valid |= uint64_t(1) << (base + j);
+    }
+  }
+  return valid;
+}
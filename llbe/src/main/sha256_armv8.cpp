@@ -0,0 +1,86 @@
+/**
+ * SHA-256 compression with the ARMv8 cryptography extensions.
+ *
+ * sha256h/sha256h2 run four rounds on the ABCD/EFGH halves of the state;
+ * sha256su0/su1 extend the message schedule four words at a time.
+ *
+ * Built with a target attribute so the rest of the binary does not require
+ * the extensions; only called after cpuHasArmv8Sha2() returned true.
+ *
+ * Not yet built or checked against the NIST vectors on aarch64, so it is
+ * compiled and dispatched only with -DLLBE_SHA256_ARMV8=ON. Turn that on on
+ * the Pi and run bench_crypto --check and Sha256Test.* before making it the
+ * default.
+ */
+
+#include "sha256_backend.hpp"
+
+#if defined(__aarch64__) && defined(LLBE_SHA256_ARMV8)
+
+#include <arm_neon.h>
+
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+#if defined(__ARM_FEATURE_SHA2)
+#define LLBE_TARGET_SHA2
+#elif defined(__clang__)
+#define LLBE_TARGET_SHA2 __attribute__((target("sha2")))
+#else
+#define LLBE_TARGET_SHA2 __attribute__((target("+crypto")))
+#endif
+
+bool crypto::sha256::cpuHasArmv8Sha2()
+{
+#if defined(__ARM_FEATURE_SHA2) || defined(__APPLE__)
+  return true;
+#elif defined(__linux__)
+  return getauxval(AT_HWCAP) & HWCAP_SHA2;
+#else
+  return false;
+#endif
+}
+
+LLBE_TARGET_SHA2
+void crypto::sha256::blocksArmv8(uint32_t state[8], const uint8_t *blocks, size_t n)
+{
+  uint32x4_t state0 = vld1q_u32(&state[0]); // ABCD
+  uint32x4_t state1 = vld1q_u32(&state[4]); // EFGH
+
+  for (; n > 0; --n, blocks += 64)
+  {
+    const uint32x4_t abcd = state0;
+    const uint32x4_t efgh = state1;
+    uint32x4_t w[4];
+
+#pragma GCC unroll 16
+    for (int g = 0; g < 16; ++g)
+    {
+      uint32x4_t &words = w[g & 3];
+      if (g < 4)
+      {
+        // Big-endian word loads
+        words = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16 * g)));
+      }
+      else
+      {
+        words = vsha256su1q_u32(vsha256su0q_u32(words, w[(g + 1) & 3]), w[(g + 2) & 3], w[(g + 3) & 3]);
+      }
+
+      uint32x4_t msg = vaddq_u32(words, vld1q_u32(&K[4 * g]));
+      uint32x4_t prev = state0;
+      state0 = vsha256hq_u32(state0, state1, msg);
+      state1 = vsha256h2q_u32(state1, prev, msg);
+    }
+
+    state0 = vaddq_u32(state0, abcd);
+    state1 = vaddq_u32(state1, efgh);
+  }
+
+  vst1q_u32(&state[0], state0);
+  vst1q_u32(&state[4], state1);
+}
+
+#endif
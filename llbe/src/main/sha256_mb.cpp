@@ -0,0 +1,186 @@
+/**
+ * Multi-buffer SHA-256: N independent messages hashed side by side, one
+ * message per 32-bit SIMD lane.
+ *
+ * A single message does not vectorise (every round depends on the one
+ * before it), but N messages run the same rounds on different data, so
+ * one vector instruction does the work of N scalar ones. Messages may have
+ * different lengths: each lane's tail is padded up front, every block index
+ * runs on all lanes, and lanes whose message has already ended keep their
+ * state (the block's result is masked out).
+ *
+ * The kernel is written once with GCC vector extensions and instantiated
+ * per width inside functions carrying the matching target attribute:
+ *   4 lanes:  baseline SSE2 on x86-64, NEON on aarch64
+ *   8 lanes:  AVX2
+ *   16 lanes: AVX-512F (rotates become vprord)
+ */
+
+#include "sha256_backend.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  typedef uint32_t V4 __attribute__((vector_size(16)));
+  typedef uint32_t V8 __attribute__((vector_size(32)));
+  typedef uint32_t V16 __attribute__((vector_size(64)));
+
+  constexpr uint32_t H0[8] = {
+      0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au,
+      0x510e527fu, 0x9b05688cu, 0x1f83d9abu, 0x5be0cd19u};
+
+  inline uint32_t loadBe32(const uint8_t *p)
+  {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+  }
+
+  // Macros rather than functions: vectors wider than the default target
+  // must not be passed by value outside the target-attributed callers
+#define MB_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define MB_BSIG0(x) (MB_ROTR(x, 2) ^ MB_ROTR(x, 13) ^ MB_ROTR(x, 22))
+#define MB_BSIG1(x) (MB_ROTR(x, 6) ^ MB_ROTR(x, 11) ^ MB_ROTR(x, 25))
+#define MB_SSIG0(x) (MB_ROTR(x, 7) ^ MB_ROTR(x, 18) ^ ((x) >> 3))
+#define MB_SSIG1(x) (MB_ROTR(x, 17) ^ MB_ROTR(x, 19) ^ ((x) >> 10))
+
+  /**
+   * Hash exactly N messages, one per lane
+   * @param data message start per lane
+   * @param len message length per lane
+   * @param out digest per lane
+   */
+  template <typename V, size_t N>
+  __attribute__((always_inline)) inline void hashLanes(const uint8_t *const data[], const size_t len[], uint8_t out[][32])
+  {
+    // Per lane: whole blocks read in place, then one or two padded tail blocks
+    size_t full[N];
+    size_t total[N];
+    alignas(64) uint8_t tail[N][128];
+    size_t max_blocks = 0;
+    for (size_t j = 0; j < N; ++j)
+    {
+      full[j] = len[j] / 64;
+      size_t rem = len[j] % 64;
+      size_t tail_len = rem + 9 > 64 ? 128 : 64;
+      std::memcpy(tail[j], data[j] + full[j] * 64, rem);
+      tail[j][rem] = 0x80;
+      std::memset(tail[j] + rem + 1, 0, tail_len - rem - 1 - 8);
+      uint64_t bitlen = static_cast<uint64_t>(len[j]) * 8ULL;
+      for (int i = 0; i < 8; ++i)
+        tail[j][tail_len - 8 + i] = static_cast<uint8_t>(bitlen >> (8 * (7 - i)));
+      total[j] = full[j] + tail_len / 64;
+      max_blocks = std::max(max_blocks, total[j]);
+    }
+
+    V state[8];
+    for (int i = 0; i < 8; ++i)
+      state[i] = V{} + H0[i];
+
+    for (size_t b = 0; b < max_blocks; ++b)
+    {
+      // Transpose: words[t] holds message word t of every lane
+      alignas(64) uint32_t words[16][N];
+      alignas(64) uint32_t live[N];
+      for (size_t j = 0; j < N; ++j)
+      {
+        const uint8_t *block;
+        if (b < full[j])
+          block = data[j] + b * 64;
+        else if (b < total[j])
+          block = tail[j] + (b - full[j]) * 64;
+        else
+          block = tail[j]; // finished; result is masked out below
+        live[j] = b < total[j] ? 0xFFFFFFFFu : 0u;
+        for (int t = 0; t < 16; ++t)
+          words[t][j] = loadBe32(block + 4 * t);
+      }
+
+      V w[16];
+      std::memcpy(w, words, sizeof(w));
+      V mask;
+      std::memcpy(&mask, live, sizeof(mask));
+
+      V a = state[0], bb = state[1], c = state[2], d = state[3];
+      V e = state[4], f = state[5], g = state[6], h = state[7];
+
+#pragma GCC unroll 64
+      for (int t = 0; t < 64; ++t)
+      {
+        if (t >= 16)
+          w[t & 15] += MB_SSIG1(w[(t - 2) & 15]) + w[(t - 7) & 15] + MB_SSIG0(w[(t - 15) & 15]);
+        V t1 = h + MB_BSIG1(e) + ((e & f) ^ (~e & g)) + crypto::sha256::K[t] + w[t & 15];
+        V t2 = MB_BSIG0(a) + ((a & bb) | (c & (a | bb)));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = bb;
+        bb = a;
+        a = t1 + t2;
+      }
+
+      state[0] += a & mask;
+      state[1] += bb & mask;
+      state[2] += c & mask;
+      state[3] += d & mask;
+      state[4] += e & mask;
+      state[5] += f & mask;
+      state[6] += g & mask;
+      state[7] += h & mask;
+    }
+
+    alignas(64) uint32_t digest[8][N];
+    std::memcpy(digest, state, sizeof(digest));
+    for (size_t j = 0; j < N; ++j)
+    {
+      for (int i = 0; i < 8; ++i)
+      {
+        out[j][i * 4 + 0] = static_cast<uint8_t>(digest[i][j] >> 24);
+        out[j][i * 4 + 1] = static_cast<uint8_t>(digest[i][j] >> 16);
+        out[j][i * 4 + 2] = static_cast<uint8_t>(digest[i][j] >> 8);
+        out[j][i * 4 + 3] = static_cast<uint8_t>(digest[i][j]);
+      }
+    }
+  }
+
+#undef MB_ROTR
+#undef MB_BSIG0
+#undef MB_BSIG1
+#undef MB_SSIG0
+#undef MB_SSIG1
+} // namespace
+
+void crypto::sha256::hashLanes4(const uint8_t *const data[], const size_t len[], uint8_t out[][32])
+{
+  hashLanes<V4, 4>(data, len, out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2")))
+void crypto::sha256::hashLanes8Avx2(const uint8_t *const data[], const size_t len[], uint8_t out[][32])
+{
+  hashLanes<V8, 8>(data, len, out);
+}
+
+__attribute__((target("avx512f")))
+void crypto::sha256::hashLanes16Avx512(const uint8_t *const data[], const size_t len[], uint8_t out[][32])
+{
+  hashLanes<V16, 16>(data, len, out);
+}
+
+bool crypto::sha256::cpuHasAvx2()
+{
+  // also checks that the OS saves the YMM/ZMM state
+  return __builtin_cpu_supports("avx2");
+}
+
+bool crypto::sha256::cpuHasAvx512()
+{
+  return __builtin_cpu_supports("avx512f");
+}
+
+#endif
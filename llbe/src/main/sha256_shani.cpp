@@ -0,0 +1,89 @@
+/**
+ * SHA-256 compression with the x86 SHA extensions (SHA-NI).
+ *
+ * The state is kept as ABEF/CDGH, the layout sha256rnds2 works on. Each
+ * group of four rounds runs two sha256rnds2 (two rounds each); the message
+ * schedule is extended four words at a time with sha256msg1/msg2.
+ *
+ * Built with a target attribute rather than -msha so the rest of the
+ * binary still runs on CPUs without the extensions; only called after
+ * cpuHasShaNi() returned true.
+ */
+
+#include "sha256_backend.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cpuid.h>
+#include <immintrin.h>
+
+bool crypto::sha256::cpuHasShaNi()
+{
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+  bool ssse3 = ecx & bit_SSSE3;
+  bool sse41 = ecx & bit_SSE4_1;
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    return false;
+  bool sha = ebx & bit_SHA;
+  return ssse3 && sse41 && sha;
+}
+
+__attribute__((target("sha,ssse3,sse4.1")))
+void crypto::sha256::blocksShaNi(uint32_t state[8], const uint8_t *blocks, size_t n)
+{
+  // Big-endian word loads
+  const __m128i BSWAP = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0]));   // DCBA
+  __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])); // HGFE
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1B);           // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);        // CDGH
+
+  for (; n > 0; --n, blocks += 64)
+  {
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+    __m128i w[4];
+
+#pragma GCC unroll 16
+    for (int g = 0; g < 16; ++g)
+    {
+      __m128i &words = w[g & 3];
+      if (g < 4)
+      {
+        words = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16 * g)), BSWAP);
+      }
+      else
+      {
+        // W[t-16] + s0(W[t-15]) + W[t-7] + s1(W[t-2]), four words at once
+        const __m128i &w1 = w[(g + 3) & 3]; // words t-4..t-1
+        const __m128i &w2 = w[(g + 2) & 3]; // words t-8..t-5
+        __m128i next = _mm_sha256msg1_epu32(words, w[(g + 1) & 3]);
+        next = _mm_add_epi32(next, _mm_alignr_epi8(w1, w2, 4));
+        words = _mm_sha256msg2_epu32(next, w1);
+      }
+
+      __m128i msg = _mm_add_epi32(words, _mm_load_si128(reinterpret_cast<const __m128i *>(&K[4 * g])));
+      state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+      msg = _mm_shuffle_epi32(msg, 0x0E);
+      state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);              // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1);           // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);        // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "timestamp.hpp"
+
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+  inline char *put2(char *p, unsigned v)
+  {
+    p[0] = static_cast<char>('0' + v / 10);
+    p[1] = static_cast<char>('0' + v % 10);
+    return p + 2;
+  }
+
+  inline char *put3(char *p, unsigned v)
+  {
+    p[0] = static_cast<char>('0' + v / 100);
+    p[1] = static_cast<char>('0' + (v / 10) % 10);
+    p[2] = static_cast<char>('0' + v % 10);
+    return p + 3;
+  }
+
+  inline char *put6(char *p, unsigned v)
+  {
+    p = put3(p, v / 1000);
+    return put3(p, v % 1000);
+  }
+
+  // Variable-width unsigned decimal
+  inline char *putUint(char *p, uint64_t v)
+  {
+    char tmp[20];
+    int n = 0;
+    do
+    {
+      tmp[n++] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while (v != 0);
+    while (n > 0)
+      *p++ = tmp[--n];
+    return p;
+  }
+
+  // Last formatted wall-clock second for this thread
+  struct SecondCache
+  {
+    int64_t second = INT64_MIN;
+    llbe::TimestampFormatter::Mode mode = llbe::TimestampFormatter::Mode::LOCAL;
+    size_t length = 0;
+    char prefix[24];
+  };
+
+  thread_local SecondCache tls_cache;
+
+  // "YYYY-MM-DD HH:MM:SS" (local) or "YYYY-MM-DDTHH:MM:SS" (UTC)
+  size_t formatSecond(int64_t second, bool utc, char *out)
+  {
+    std::time_t t = static_cast<std::time_t>(second);
+    std::tm tm{};
+    if (utc)
+      gmtime_r(&t, &tm);
+    else
+      localtime_r(&t, &tm);
+
+    char *p = out;
+    unsigned year = static_cast<unsigned>(tm.tm_year + 1900);
+    p = put2(p, year / 100);
+    p = put2(p, year % 100);
+    *p++ = '-';
+    p = put2(p, static_cast<unsigned>(tm.tm_mon + 1));
+    *p++ = '-';
+    p = put2(p, static_cast<unsigned>(tm.tm_mday));
+    *p++ = utc ? 'T' : ' ';
+    p = put2(p, static_cast<unsigned>(tm.tm_hour));
+    *p++ = ':';
+    p = put2(p, static_cast<unsigned>(tm.tm_min));
+    *p++ = ':';
+    p = put2(p, static_cast<unsigned>(tm.tm_sec));
+    return static_cast<size_t>(p - out);
+  }
+}
+
+size_t llbe::TimestampFormatter::format(int64_t stamp_ns, char *out) const
+{
+  if (stamp_ns < 0)
+    stamp_ns = 0;
+
+  Mode m = mode();
+  uint64_t ns = static_cast<uint64_t>(stamp_ns);
+  char *p = out;
+
+  switch (m)
+  {
+  case Mode::EPOCH_US:
+    p = putUint(p, ns / 1000);
+    break;
+
+  case Mode::MONOTONIC:
+    p = putUint(p, ns / 1000000000ULL);
+    *p++ = '.';
+    p = put6(p, static_cast<unsigned>((ns / 1000) % 1000000));
+    break;
+
+  case Mode::LOCAL:
+  case Mode::UTC:
+  default:
+  {
+    int64_t second = static_cast<int64_t>(ns / 1000000000ULL);
+    SecondCache &cache = tls_cache;
+    if (cache.second != second || cache.mode != m)
+    {
+      cache.length = formatSecond(second, m == Mode::UTC, cache.prefix);
+      cache.second = second;
+      cache.mode = m;
+    }
+
+    std::memcpy(p, cache.prefix, cache.length);
+    p += cache.length;
+    *p++ = '.';
+    p = put3(p, static_cast<unsigned>((ns / 1000000) % 1000));
+    if (m == Mode::UTC)
+      *p++ = 'Z';
+    break;
+  }
+  }
+
+  return static_cast<size_t>(p - out);
+}
+
+std::string llbe::TimestampFormatter::toString(int64_t stamp_ns) const
+{
+  char buf[MAX_LENGTH];
+  return std::string(buf, format(stamp_ns, buf));
+}
+
+bool llbe::TimestampFormatter::modeFromString(const std::string &name, Mode &out)
+{
+  if (name == "local")
+    out = Mode::LOCAL;
+  else if (name == "utc")
+    out = Mode::UTC;
+  else if (name == "monotonic")
+    out = Mode::MONOTONIC;
+  else if (name == "epoch_us")
+    out = Mode::EPOCH_US;
+  else
+    return false;
+  return true;
+}
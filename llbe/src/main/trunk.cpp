@@ -21,7 +21,7 @@ bool llbe::BackendConnectivityTrunk::connect()
 
   if (!ws_ || ws_->isClosed())
   {
-    Logger::getInstance().log(Logger::Level::ERROR, "WebSocket not initialized");
+    LOG_CAT_ERROR(TRUNK, "WebSocket not initialized");
     ws_ = std::make_shared<rtc::WebSocket>();
     ws_->open(config_->server.address);
   }
@@ -30,7 +30,7 @@ bool llbe::BackendConnectivityTrunk::connect()
     return true;
 
   ws_->onOpen([this]() {
-    Logger::getInstance().log(Logger::Level::INFO, "WebSocket connection opened");
+    LOG_CAT_INFO(TRUNK, "WebSocket connection opened");
     json j = {
       { "type", "user:auth" },
       { "username", "llbe" },
@@ -42,11 +42,11 @@ bool llbe::BackendConnectivityTrunk::connect()
   });
 
   ws_->onClosed([]() {
-    Logger::getInstance().log(Logger::Level::WARNING, "WebSocket connection closed");
+    LOG_CAT_WARNING(TRUNK, "WebSocket connection closed");
   });
 
   ws_->onError([](std::string error) {
-    Logger::getInstance().log(Logger::Level::ERROR, "WebSocket error: " + error);
+    LOG_CAT_ERRORF(TRUNK, "WebSocket error: {}", error);
   });
 
   return true;
@@ -57,12 +57,12 @@ void llbe::BackendConnectivityTrunk::disconnect()
   std::lock_guard<std::mutex> lock(ws_mutex_);
   if (!ws_ || !ws_->isOpen())
   {
-    Logger::getInstance().log(Logger::Level::INFO, "WebSocket close() already was disconnected");
+    LOG_CAT_INFO(TRUNK, "WebSocket close() already was disconnected");
     return;
   }
 
   ws_->close();
-  Logger::getInstance().log(Logger::Level::INFO, "WebSocket connection closed by client");
+  LOG_CAT_INFO(TRUNK, "WebSocket connection closed by client");
 }
 
 bool llbe::BackendConnectivityTrunk::isConnected() const
@@ -86,8 +86,7 @@ void llbe::BackendConnectivityTrunk::backgroundTask()
       this->connect();
       std::this_thread::sleep_for(std::chrono::seconds(eb_timeout_.count()));
       eb_timeout_ = std::min(eb_timeout_ * 2, std::chrono::seconds(EB_MAX_TIMEOUT_SEC));
-      LOG_ERROR("WebSocket not connected, retrying in " +
-        std::to_string(eb_timeout_.count()) + " seconds");
+      LOG_CAT_ERRORF(TRUNK, "WebSocket not connected, retrying in {} seconds", eb_timeout_.count());
 
       continue;
     }
@@ -6,41 +6,87 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <cerrno>
 #include <iostream>
 
+namespace
+{
+  uint64_t monotonic_us()
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+}
+
 llbe::RobotUDPSession::~RobotUDPSession()
 {
   if (sockfd_ >= 0)
   {
+    flush();
     close(sockfd_);
-    LOG_INFO("Closed UDP socket on " + bind_address_ + ":" + std::to_string(bind_port_));
+    LOG_CAT_INFO(UDP, "Closed UDP socket on " + bind_address_ + ":" + std::to_string(bind_port_));
   }
 }
 
 void llbe::RobotUDPSession::send_message(const std::string& message)
+{
+  send_datagram(reinterpret_cast<const uint8_t*>(message.data()), message.size());
+}
+
+bool llbe::RobotUDPSession::send_datagram(const uint8_t* data, size_t len)
 {
   if (sockfd_ < 0)
   {
-    LOG_ERROR("Attempted to send on invalid UDP socket");
-    return;
+    LOG_CAT_ERROR(UDP, "Attempted to send on invalid UDP socket");
+    return false;
   }
 
   struct iovec iov{
-    .iov_base = const_cast<char*>(message.data()),
-    .iov_len = message.size()
+    .iov_base = const_cast<uint8_t*>(data),
+    .iov_len = len
   };
 
-  // Build packet to send
-  struct msghdr msg{
-    .msg_iov = &iov,
-    .msg_iovlen = 1,
-    .msg_name = nullptr
-  };
+  // Build packet to send (connected socket, no destination address)
+  struct msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
 
-  sendmsg(sockfd_, nullptr, 0); // Dummy call to suppress unused parameter warning
+  if (sendmsg(sockfd_, &msg, 0) < 0)
+  {
+    LOG_CAT_ERRORF(UDP, "Failed to send UDP message: {}", std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+bool llbe::RobotUDPSession::queue_message(uint8_t message_type, const uint8_t* payload, size_t len)
+{
+  if (len > bundle_.maxEntry())
+  {
+    LOG_CAT_ERRORF(UDP, "Message of {} bytes does not fit in one datagram", len);
+    return false;
+  }
+  if (!bundle_.fits(len))
+    flush();
+  return bundle_.add(message_type, payload, len);
+}
 
-  // if (sent_bytes < 0)
-  // {
-  //   LOG_ERROR("Failed to send UDP message: " + std::string(std::strerror(errno)));
-  // }
+void llbe::RobotUDPSession::flush()
+{
+  if (bundle_.empty())
+    return;
+  std::span<const uint8_t> datagram = bundle_.finish(tx_sequence_++, monotonic_us());
+  if (datagram.empty())
+    LOG_CAT_ERROR(UDP, "Cannot seal datagram: integrity key not set");
+  else
+    send_datagram(datagram.data(), datagram.size());
+  bundle_.clear();
+}
+
+shr::Admission llbe::RobotUDPSession::admit(const shr::FrameView& frame)
+{
+  shr::Admission admission = rx_.admit(frame.sequence, frame.timestamp_us, monotonic_us());
+  if (admission == shr::Admission::STALE)
+    LOG_CAT_DEBUGF(UDP, "Stale datagram", llbe::kv("peer", bind_address_), llbe::kv("sequence", frame.sequence));
+  return admission;
 }
@@ -0,0 +1,335 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "crypto.hpp"
+#include "msg.hpp"
+#include "sha256_backend.hpp"
+
+namespace {
+    std::string toHex(const uint8_t digest[32]) {
+        std::string hex;
+        char byte[3];
+        for (int i = 0; i < 32; ++i) {
+            std::snprintf(byte, sizeof(byte), "%02x", digest[i]);
+            hex += byte;
+        }
+        return hex;
+    }
+
+    std::string hashWith(const crypto::sha256::Backend &backend, const std::string &message) {
+        uint8_t digest[32];
+        crypto::sha256::hash(backend, reinterpret_cast<const uint8_t *>(message.data()), message.size(), digest);
+        return toHex(digest);
+    }
+
+    // NIST FIPS 180-2 examples
+    struct Vector {
+        std::string message;
+        const char *digest;
+    };
+
+    std::vector<Vector> nistVectors() {
+        return {
+            {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+            {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+            {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+            {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+             "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+            {std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+        };
+    }
+}
+
+TEST(Sha256Test, NistVectorsOnEveryBackend) {
+    for (const auto &backend : crypto::sha256::backends()) {
+        if (!backend.supported()) {
+            continue;
+        }
+        SCOPED_TRACE(backend.name);
+        for (const auto &vector : nistVectors()) {
+            EXPECT_EQ(hashWith(backend, vector.message), vector.digest);
+        }
+    }
+}
+
+TEST(Sha256Test, BackendsMatchScalar) {
+    const auto backends = crypto::sha256::backends();
+    const auto &scalar = backends.back();
+    ASSERT_STREQ(scalar.name, "scalar");
+
+    // Every padding shape (0..300 bytes) plus a few multi-block messages
+    std::vector<size_t> lengths;
+    for (size_t len = 0; len <= 300; ++len) {
+        lengths.push_back(len);
+    }
+    lengths.insert(lengths.end(), {1023, 1024, 2304, 8986, 9000});
+
+    for (const auto &backend : backends) {
+        if (!backend.supported()) {
+            continue;
+        }
+        SCOPED_TRACE(backend.name);
+        for (size_t len : lengths) {
+            std::string message(len, '\0');
+            for (size_t i = 0; i < len; ++i) {
+                message[i] = static_cast<char>(i * 131 + len);
+            }
+            EXPECT_EQ(hashWith(backend, message), hashWith(scalar, message)) << "length " << len;
+        }
+    }
+}
+
+TEST(Sha256Test, ActiveBackendIsSupported) {
+    const auto &active = crypto::sha256::active();
+    EXPECT_TRUE(active.supported());
+    for (const auto &backend : crypto::sha256::backends()) {
+        if (backend.supported()) {
+            // first supported backend wins
+            EXPECT_EQ(&backend, &active);
+            break;
+        }
+    }
+}
+
+TEST(Sha256Test, Verify) {
+    const std::string message = "abc";
+    const auto *data = reinterpret_cast<const uint8_t *>(message.data());
+    uint8_t digest[32];
+    crypto::sha256_hash(data, static_cast<int>(message.size()), digest);
+    EXPECT_EQ(toHex(digest), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_TRUE(crypto::sha256_verify(data, static_cast<int>(message.size()), digest));
+
+    digest[31] ^= 0x01;
+    EXPECT_FALSE(crypto::sha256_verify(data, static_cast<int>(message.size()), digest));
+}
+
+TEST(Sha256Test, IncrementalMatchesOneShot) {
+    std::string message(1000, '\0');
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = static_cast<char>(i * 7);
+    }
+    const auto *data = reinterpret_cast<const uint8_t *>(message.data());
+
+    for (const auto &backend : crypto::sha256::backends()) {
+        if (!backend.supported()) {
+            continue;
+        }
+        SCOPED_TRACE(backend.name);
+        crypto::Sha256 ctx(backend.blocks);
+        // Chunk sizes that straddle, fill and skip the partial block buffer
+        for (size_t chunk : {1, 3, 55, 56, 63, 64, 65, 200, 1000}) {
+            for (size_t len : {0, 1, 55, 56, 64, 119, 120, 128, 1000}) {
+                for (size_t offset = 0; offset < len; offset += chunk) {
+                    ctx.update(data + offset, std::min(chunk, len - offset));
+                }
+                uint8_t incremental[32];
+                uint8_t oneshot[32];
+                ctx.final(incremental);
+                crypto::sha256::hash(backend, data, len, oneshot);
+                EXPECT_EQ(toHex(incremental), toHex(oneshot)) << "chunk " << chunk << " length " << len;
+            }
+        }
+    }
+}
+
+TEST(Sha256Test, IovecMatchesConcatenation) {
+    const std::string header = "abcdbcdecdefdefgefgh";
+    const std::string payload = "fghighijhijkijkljklmklmnlmnomno";
+    const std::string trailer = "pnopq";
+    struct iovec iov[] = {
+        {const_cast<char *>(header.data()), header.size()},
+        {nullptr, 0},
+        {const_cast<char *>(payload.data()), payload.size()},
+        {const_cast<char *>(trailer.data()), trailer.size()},
+    };
+
+    uint8_t digest[32];
+    crypto::sha256_hash(iov, 4, digest);
+    EXPECT_EQ(toHex(digest), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    crypto::sha256_hash(iov, 0, digest);
+    EXPECT_EQ(toHex(digest), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(Sha256Test, BatchBackendsMatchScalar) {
+    // Mixed lengths in one batch, including empty and multi-block messages
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < 37; ++i) {
+        size_t len = (i * 61) % 300 + (i % 5 == 0 ? 2000 : 0);
+        std::string message(len, '\0');
+        for (size_t k = 0; k < len; ++k) {
+            message[k] = static_cast<char>(k * 13 + i);
+        }
+        messages.push_back(message);
+    }
+    std::vector<const uint8_t *> data;
+    std::vector<size_t> lens;
+    for (const auto &message : messages) {
+        data.push_back(reinterpret_cast<const uint8_t *>(message.data()));
+        lens.push_back(message.size());
+    }
+
+    const auto &scalar = crypto::sha256::backends().back();
+    for (const auto &backend : crypto::sha256::batchBackends()) {
+        if (!backend.supported()) {
+            continue;
+        }
+        SCOPED_TRACE(backend.name);
+        // Every count up to the full set exercises the partial last vector
+        for (size_t count = 0; count <= messages.size(); ++count) {
+            std::vector<uint8_t[32]> out(count);
+            crypto::sha256::hashBatch(backend, data.data(), lens.data(), out.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(toHex(out[i]), hashWith(scalar, messages[i])) << "count " << count << " message " << i;
+            }
+        }
+    }
+}
+
+TEST(Sha256Test, VerifyBatchBitmask) {
+    constexpr int COUNT = 40;
+    std::vector<std::string> messages;
+    std::vector<std::array<uint8_t, 32>> digests(COUNT);
+    crypto::Sha256VerifyJob jobs[COUNT];
+    for (int i = 0; i < COUNT; ++i) {
+        messages.push_back(std::string(static_cast<size_t>(i * 57), static_cast<char>('a' + i % 26)));
+    }
+    for (int i = 0; i < COUNT; ++i) {
+        const auto *data = reinterpret_cast<const uint8_t *>(messages[i].data());
+        crypto::sha256_hash(data, static_cast<int>(messages[i].size()), digests[i].data());
+        jobs[i] = {data, static_cast<int>(messages[i].size()), digests[i].data()};
+    }
+
+    uint64_t all = (uint64_t(1) << COUNT) - 1;
+    EXPECT_EQ(crypto::sha256_verify_batch(jobs, COUNT), all);
+
+    digests[3][0] ^= 0x80;
+    digests[17][31] ^= 0x01;
+    messages[39][0] ^= 0x20;
+    EXPECT_EQ(crypto::sha256_verify_batch(jobs, COUNT), all & ~((uint64_t(1) << 3) | (uint64_t(1) << 17) | (uint64_t(1) << 39)));
+    EXPECT_EQ(crypto::sha256_verify_batch(jobs, 0), 0u);
+}
+
+TEST(Sha256Test, WireableMessageVerifyBatch) {
+    struct __attribute__((packed)) Payload {
+        int32_t left;
+        int32_t right;
+    };
+    using Message = shr::WireableMessage<Payload>;
+
+    Message messages[5];
+    const Message *received[5];
+    for (int i = 0; i < 5; ++i) {
+        messages[i].payload = {i, -i};
+        ASSERT_TRUE(messages[i].prepare(shr::MessageHeader::MSG_TYPE_COMMAND, sizeof(Payload)));
+        received[i] = &messages[i];
+    }
+    EXPECT_TRUE(messages[0].isValid());
+    EXPECT_EQ(shr::verifyBatch(received, 5), 0x1Fu);
+
+    messages[2].payload.right = 7;
+    EXPECT_FALSE(messages[2].verify());
+    EXPECT_EQ(shr::verifyBatch(received, 5), 0x1Bu);
+}
+
+TEST(Crc32cTest, KnownValues) {
+    const std::string check = "123456789";
+    const auto *data = reinterpret_cast<const uint8_t *>(check.data());
+    EXPECT_EQ(crypto::crc32c(data, check.size()), 0xE3069283u);
+    EXPECT_EQ(crypto::crc32c(data, 0), 0u);
+
+    // In pieces, across the 8-byte stride
+    uint32_t crc = crypto::crc32c(data, 3);
+    crc = crypto::crc32c(data + 3, 6, crc);
+    EXPECT_EQ(crc, 0xE3069283u);
+
+    std::string zeros(32, '\0');
+    EXPECT_EQ(crypto::crc32c(reinterpret_cast<const uint8_t *>(zeros.data()), zeros.size()), 0x8A9136AAu);
+}
+
+TEST(HmacSha256Test, Rfc4231Vectors) {
+    auto mac = [](const std::string &key, const std::string &message) {
+        crypto::HmacSha256Key hmac(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+        uint8_t out[32];
+        hmac.mac(reinterpret_cast<const uint8_t *>(message.data()), message.size(), out);
+        return toHex(out);
+    };
+
+    EXPECT_EQ(mac(std::string(20, '\x0b'), "Hi There"),
+              "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+    EXPECT_EQ(mac("Jefe", "what do ya want for nothing?"),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    // Key longer than a block is hashed first
+    EXPECT_EQ(mac(std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First"),
+              "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+namespace {
+    struct __attribute__((packed)) DrivePayload {
+        int16_t left;
+        int16_t right;
+    };
+
+    template <shr::Integrity MODE>
+    void expectSealAndTamper() {
+        shr::WireableMessage<DrivePayload, MODE> message;
+        message.payload = {100, -100};
+        ASSERT_TRUE(message.prepare(shr::MessageHeader::MSG_TYPE_COMMAND, sizeof(DrivePayload)));
+        EXPECT_EQ(message.header.integrity, static_cast<uint8_t>(MODE));
+        EXPECT_TRUE(message.isValid());
+
+        message.payload.left = 101;
+        EXPECT_EQ(message.isValid(), MODE == shr::Integrity::NONE);
+    }
+}
+
+TEST(IntegrityTest, TrailerSizes) {
+    constexpr size_t BODY = sizeof(shr::MessageHeader) + sizeof(DrivePayload);
+    EXPECT_EQ(sizeof(shr::WireableMessage<DrivePayload, shr::Integrity::NONE>), BODY);
+    EXPECT_EQ(sizeof(shr::WireableMessage<DrivePayload, shr::Integrity::CRC32C>), BODY + 4);
+    EXPECT_EQ(sizeof(shr::WireableMessage<DrivePayload, shr::Integrity::HMAC_SHA256_128>), BODY + 16);
+    EXPECT_EQ(sizeof(shr::WireableMessage<DrivePayload, shr::Integrity::SHA256>), BODY + 32);
+
+    EXPECT_EQ(shr::defaultIntegrity(shr::MessageHeader::MSG_TYPE_COMMAND), shr::Integrity::HMAC_SHA256_128);
+    EXPECT_EQ(shr::defaultIntegrity(shr::MessageHeader::MSG_TYPE_STATUS), shr::Integrity::CRC32C);
+}
+
+TEST(IntegrityTest, SealAndDetectTampering) {
+    const std::string key = "drive-key";
+    shr::setIntegrityKey(reinterpret_cast<const uint8_t *>(key.data()), key.size());
+
+    expectSealAndTamper<shr::Integrity::NONE>();
+    expectSealAndTamper<shr::Integrity::CRC32C>();
+    expectSealAndTamper<shr::Integrity::HMAC_SHA256_128>();
+    expectSealAndTamper<shr::Integrity::SHA256>();
+
+    // A different key rejects the MAC
+    shr::WireableMessage<DrivePayload, shr::Integrity::HMAC_SHA256_128> message;
+    message.payload = {1, 2};
+    ASSERT_TRUE(message.prepare(shr::MessageHeader::MSG_TYPE_COMMAND, sizeof(DrivePayload)));
+    EXPECT_TRUE(message.verify());
+    const std::string other = "other-key";
+    shr::setIntegrityKey(reinterpret_cast<const uint8_t *>(other.data()), other.size());
+    EXPECT_FALSE(message.verify());
+}
+
+TEST(IntegrityTest, SealWithoutKeyFails) {
+    const crypto::HmacSha256Key saved = shr::integrityKey();
+    shr::integrityKey() = crypto::HmacSha256Key();
+
+    shr::WireableMessage<DrivePayload, shr::Integrity::HMAC_SHA256_128> command;
+    command.payload = {1, 2};
+    EXPECT_FALSE(command.prepare(shr::MessageHeader::MSG_TYPE_COMMAND, sizeof(DrivePayload)));
+    EXPECT_FALSE(command.verify());
+
+    // Modes without a key are unaffected
+    shr::WireableMessage<DrivePayload, shr::Integrity::CRC32C> status;
+    status.payload = {1, 2};
+    EXPECT_TRUE(status.prepare(shr::MessageHeader::MSG_TYPE_STATUS, sizeof(DrivePayload)));
+
+    shr::integrityKey() = saved;
+}
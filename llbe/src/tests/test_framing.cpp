@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "bundle.hpp"
+#include "framing.hpp"
+#include "udp.hpp"
+
+namespace {
+    // What sendmsg would put on the wire
+    std::vector<uint8_t> gather(std::span<const struct iovec> iov) {
+        std::vector<uint8_t> wire;
+        for (const auto &part : iov) {
+            const auto *bytes = static_cast<const uint8_t *>(part.iov_base);
+            wire.insert(wire.end(), bytes, bytes + part.iov_len);
+        }
+        return wire;
+    }
+
+    const uint8_t *bytes(const std::string &s) {
+        return reinterpret_cast<const uint8_t *>(s.data());
+    }
+}
+
+TEST(FramingTest, HeaderLayoutIsLittleEndian) {
+    shr::FrameEncoder encoder;
+    std::string payload(0x0123, 'x');
+    auto iov = encoder.encode(shr::MessageHeader::MSG_TYPE_LOG, shr::Integrity::NONE, bytes(payload), payload.size());
+    ASSERT_EQ(iov.size(), 2u);
+    EXPECT_EQ(iov[1].iov_base, payload.data()); // payload is not copied
+
+    std::vector<uint8_t> wire = gather(iov);
+    ASSERT_EQ(wire.size(), shr::FRAME_HEADER_SIZE + payload.size());
+    EXPECT_EQ(wire[0], shr::MessageHeader::CURRENT_VERSION);
+    EXPECT_EQ(wire[1], shr::MessageHeader::MSG_TYPE_LOG);
+    EXPECT_EQ(wire[2], 0x23);
+    EXPECT_EQ(wire[3], 0x01);
+    EXPECT_EQ(wire[4], static_cast<uint8_t>(shr::Integrity::NONE));
+}
+
+TEST(FramingTest, RoundTripEveryIntegrityMode) {
+    const std::string key = "framing-key";
+    shr::setIntegrityKey(bytes(key), key.size());
+
+    const std::string payload = "status batch: v=12.1 i=0.8 t=41";
+    for (auto mode : {shr::Integrity::NONE, shr::Integrity::CRC32C, shr::Integrity::HMAC_SHA256_128, shr::Integrity::SHA256}) {
+        SCOPED_TRACE(static_cast<int>(mode));
+        shr::FrameEncoder encoder;
+        auto iov = encoder.encode(shr::MessageHeader::MSG_TYPE_STATUS, mode, bytes(payload), payload.size());
+        std::vector<uint8_t> wire = gather(iov);
+        ASSERT_EQ(wire.size(), shr::FrameEncoder::frameSize(payload.size(), mode));
+
+        shr::FrameView view;
+        ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+        EXPECT_EQ(view.message_type, shr::MessageHeader::MSG_TYPE_STATUS);
+        EXPECT_EQ(view.integrity, mode);
+        EXPECT_EQ(std::string(reinterpret_cast<const char *>(view.payload), view.payload_length), payload);
+        EXPECT_EQ(view.frame_length, wire.size());
+
+        // A flipped payload bit is caught by every mode but NONE
+        wire[shr::FRAME_HEADER_SIZE + 3] ^= 0x04;
+        EXPECT_EQ(shr::decodeFrame(wire.data(), wire.size(), view),
+                  mode == shr::Integrity::NONE ? shr::FrameError::NONE : shr::FrameError::INTEGRITY);
+    }
+}
+
+TEST(FramingTest, RejectsMalformedFrames) {
+    shr::FrameEncoder encoder;
+    const std::string payload = "hello";
+    std::vector<uint8_t> wire = gather(encoder.encode(shr::MessageHeader::MSG_TYPE_LOG, shr::Integrity::CRC32C, bytes(payload), payload.size()));
+
+    shr::FrameView view;
+    EXPECT_EQ(shr::decodeFrame(wire.data(), 3, view), shr::FrameError::TRUNCATED);
+    EXPECT_EQ(shr::decodeFrame(wire.data(), wire.size() - 1, view), shr::FrameError::TRUNCATED);
+
+    std::vector<uint8_t> bad_version = wire;
+    bad_version[0] = 1;
+    EXPECT_EQ(shr::decodeFrame(bad_version.data(), bad_version.size(), view), shr::FrameError::VERSION);
+
+    std::vector<uint8_t> bad_mode = wire;
+    bad_mode[4] = 9;
+    EXPECT_EQ(shr::decodeFrame(bad_mode.data(), bad_mode.size(), view), shr::FrameError::INTEGRITY);
+
+    // Trailing bytes belong to the next frame
+    wire.push_back(0xAA);
+    ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+    EXPECT_EQ(view.frame_length, wire.size() - 1);
+
+    EXPECT_TRUE(encoder.encode(shr::MessageHeader::MSG_TYPE_LOG, shr::Integrity::NONE, nullptr, shr::FRAME_MAX_PAYLOAD + 1).empty());
+}
+
+TEST(FramingTest, WireableMessageDecodesAsFrame) {
+    struct __attribute__((packed)) Drive {
+        int16_t left;
+        int16_t right;
+    };
+    shr::WireableMessage<Drive, shr::Integrity::CRC32C> message;
+    message.payload = {300, -300};
+    ASSERT_TRUE(message.prepare(shr::MessageHeader::MSG_TYPE_COMMAND, sizeof(Drive)));
+
+    shr::FrameView view;
+    ASSERT_EQ(shr::decodeFrame(reinterpret_cast<const uint8_t *>(&message), sizeof(message), view), shr::FrameError::NONE);
+    EXPECT_EQ(view.payload_length, sizeof(Drive));
+    EXPECT_EQ(view.frame_length, sizeof(message));
+}
+
+TEST(BundleTest, PacksUntilMtuAndIteratesInPlace) {
+    shr::BundleEncoder bundle(128, shr::Integrity::CRC32C);
+    const std::string heartbeat = "hb";
+    const std::string status = std::string(40, 's');
+
+    EXPECT_TRUE(bundle.add(shr::MessageHeader::MSG_TYPE_HEARTBEAT, bytes(heartbeat), heartbeat.size()));
+    EXPECT_TRUE(bundle.add(shr::MessageHeader::MSG_TYPE_STATUS, bytes(status), status.size()));
+    EXPECT_TRUE(bundle.add(shr::MessageHeader::MSG_TYPE_STATUS, bytes(status), status.size()));
+    // 13 + (3+2) + 2*(3+40) = 104 used; another status needs 43 + 4 trailer
+    EXPECT_FALSE(bundle.fits(status.size()));
+    EXPECT_FALSE(bundle.add(shr::MessageHeader::MSG_TYPE_STATUS, bytes(status), status.size()));
+    EXPECT_EQ(bundle.count(), 3u);
+
+    std::span<const uint8_t> datagram = bundle.finish();
+    ASSERT_LE(datagram.size(), 128u);
+    std::vector<uint8_t> wire(datagram.begin(), datagram.end());
+
+    shr::FrameView view;
+    ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+    EXPECT_EQ(view.message_type, shr::MessageHeader::MSG_TYPE_BUNDLE);
+
+    shr::BundleReader reader(view);
+    std::vector<shr::SubMessage> messages;
+    for (shr::SubMessage message; reader.next(message);) {
+        // Entries point into the receive buffer
+        EXPECT_GE(message.payload, wire.data());
+        EXPECT_LE(message.payload + message.length, wire.data() + wire.size());
+        messages.push_back(message);
+    }
+    EXPECT_FALSE(reader.malformed());
+    ASSERT_EQ(messages.size(), 3u);
+    EXPECT_EQ(messages[0].message_type, shr::MessageHeader::MSG_TYPE_HEARTBEAT);
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(messages[0].payload), messages[0].length), heartbeat);
+    EXPECT_EQ(messages[2].length, status.size());
+
+    bundle.clear();
+    EXPECT_TRUE(bundle.empty());
+    EXPECT_EQ(bundle.maxEntry(), 128u - 13 - 3 - 4);
+}
+
+TEST(BundleTest, MtuClampedToLargestFrame) {
+    shr::BundleEncoder bundle(100000, shr::Integrity::CRC32C);
+    EXPECT_EQ(bundle.mtu(), shr::FRAME_HEADER_SIZE + shr::FRAME_MAX_PAYLOAD + 4);
+    EXPECT_EQ(bundle.maxEntry(), shr::FRAME_MAX_PAYLOAD - shr::BUNDLE_ENTRY_HEADER_SIZE);
+
+    const std::vector<uint8_t> chunk(30000, 0xAB);
+    EXPECT_TRUE(bundle.add(shr::MessageHeader::MSG_TYPE_LOG, chunk.data(), chunk.size()));
+    EXPECT_TRUE(bundle.add(shr::MessageHeader::MSG_TYPE_LOG, chunk.data(), chunk.size()));
+    EXPECT_FALSE(bundle.add(shr::MessageHeader::MSG_TYPE_LOG, chunk.data(), chunk.size()));
+
+    std::span<const uint8_t> datagram = bundle.finish();
+    shr::FrameView view;
+    ASSERT_EQ(shr::decodeFrame(datagram.data(), datagram.size(), view), shr::FrameError::NONE);
+    EXPECT_EQ(view.payload_length, 2 * (shr::BUNDLE_ENTRY_HEADER_SIZE + chunk.size()));
+}
+
+TEST(BundleTest, PlainFrameAndMalformedBundles) {
+    shr::FrameEncoder encoder;
+    const std::string payload = "single";
+    std::vector<uint8_t> wire = gather(encoder.encode(shr::MessageHeader::MSG_TYPE_LOG, shr::Integrity::NONE, bytes(payload), payload.size()));
+    shr::FrameView view;
+    ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+
+    // A plain frame yields itself once
+    shr::BundleReader plain(view);
+    shr::SubMessage message;
+    ASSERT_TRUE(plain.next(message));
+    EXPECT_EQ(message.message_type, shr::MessageHeader::MSG_TYPE_LOG);
+    EXPECT_EQ(message.length, payload.size());
+    EXPECT_FALSE(plain.next(message));
+
+    // Also when it is empty
+    for (shr::Integrity mode : {shr::Integrity::NONE, shr::Integrity::CRC32C}) {
+        std::vector<uint8_t> empty_wire = gather(encoder.encode(shr::MessageHeader::MSG_TYPE_HEARTBEAT, mode, nullptr, 0));
+        shr::FrameView empty;
+        ASSERT_EQ(shr::decodeFrame(empty_wire.data(), empty_wire.size(), empty), shr::FrameError::NONE);
+        shr::BundleReader reader(empty);
+        ASSERT_TRUE(reader.next(message));
+        EXPECT_EQ(message.length, 0u);
+        EXPECT_FALSE(reader.next(message));
+        EXPECT_FALSE(reader.next(message));
+    }
+
+    // An entry claiming more bytes than the bundle holds
+    const uint8_t entries[] = {shr::MessageHeader::MSG_TYPE_STATUS, 2, 0, 'o', 'k', shr::MessageHeader::MSG_TYPE_STATUS, 50, 0, 'x'};
+    wire = gather(encoder.encode(shr::MessageHeader::MSG_TYPE_BUNDLE, shr::Integrity::CRC32C, entries, sizeof(entries)));
+    ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+    shr::BundleReader reader(view);
+    EXPECT_TRUE(reader.next(message));
+    EXPECT_FALSE(reader.next(message));
+    EXPECT_TRUE(reader.malformed());
+
+    EXPECT_TRUE(shr::integrityCovers(shr::Integrity::HMAC_SHA256_128, shr::defaultIntegrity(shr::MessageHeader::MSG_TYPE_COMMAND)));
+    EXPECT_FALSE(shr::integrityCovers(shr::Integrity::CRC32C, shr::defaultIntegrity(shr::MessageHeader::MSG_TYPE_COMMAND)));
+}
+
+TEST(BundleTest, SessionSendsOneDatagramPerFlush) {
+    int fds[2];
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+    {
+        llbe::RobotUDPSession session(fds[0], "local", 0, 64, shr::Integrity::CRC32C);
+        const std::string status(20, 's');
+        for (int i = 0; i < 4; ++i) {
+            // 13 + 2*(3+20) + 4 = 63; the third message starts a new datagram
+            EXPECT_TRUE(session.queue_message(shr::MessageHeader::MSG_TYPE_STATUS, bytes(status), status.size()));
+        }
+        EXPECT_FALSE(session.queue_message(shr::MessageHeader::MSG_TYPE_STATUS, nullptr, 100));
+        session.flush();
+    }
+
+    int datagrams = 0;
+    size_t messages = 0;
+    uint8_t buffer[256];
+    ssize_t n;
+    while ((n = recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        shr::FrameView view;
+        ASSERT_EQ(shr::decodeFrame(buffer, static_cast<size_t>(n), view), shr::FrameError::NONE);
+        shr::BundleReader reader(view);
+        for (shr::SubMessage message; reader.next(message);) {
+            ++messages;
+        }
+        ++datagrams;
+    }
+    close(fds[1]);
+    EXPECT_EQ(datagrams, 2);
+    EXPECT_EQ(messages, 4u);
+}
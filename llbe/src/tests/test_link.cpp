@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include "framing.hpp"
+#include "link.hpp"
+
+using shr::Admission;
+
+TEST(LinkReceiverTest, InOrderWithGaps) {
+    shr::LinkReceiver link;
+    EXPECT_EQ(link.admit(100, 0, 1000), Admission::NEW);
+    EXPECT_EQ(link.admit(101, 1000, 2000), Admission::NEW);
+    EXPECT_EQ(link.admit(104, 4000, 5000), Admission::NEW); // 102, 103 missing
+
+    shr::LinkStats stats = link.stats();
+    EXPECT_EQ(stats.received, 3u);
+    EXPECT_EQ(stats.lost, 2u);
+    EXPECT_EQ(stats.reordered, 0u);
+    EXPECT_DOUBLE_EQ(stats.jitter_us, 0.0); // constant transit
+}
+
+TEST(LinkReceiverTest, ReorderDuplicateAndTooOld) {
+    shr::LinkReceiver link;
+    EXPECT_EQ(link.admit(10, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(12, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(11, 0, 0), Admission::REORDERED);
+    EXPECT_EQ(link.admit(11, 0, 0), Admission::DUPLICATE);
+    EXPECT_EQ(link.admit(12, 0, 0), Admission::DUPLICATE);
+
+    EXPECT_EQ(link.admit(12 + shr::LinkReceiver::WINDOW + 5, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(13, 0, 0), Admission::TOO_OLD);
+    EXPECT_EQ(link.admit(9, 0, 0), Admission::TOO_OLD); // before the first datagram
+
+    shr::LinkStats stats = link.stats();
+    EXPECT_EQ(stats.received, 4u);
+    EXPECT_EQ(stats.reordered, 1u);
+    EXPECT_EQ(stats.duplicates, 2u);
+    EXPECT_EQ(stats.too_old, 2u);
+    EXPECT_EQ(stats.lost, (shr::LinkReceiver::WINDOW + 5 + 3) - 4u);
+
+    // Commands are latest-wins, telemetry takes late datagrams
+    EXPECT_TRUE(shr::admits(Admission::NEW, shr::MessageHeader::MSG_TYPE_COMMAND));
+    EXPECT_FALSE(shr::admits(Admission::REORDERED, shr::MessageHeader::MSG_TYPE_COMMAND));
+    EXPECT_TRUE(shr::admits(Admission::REORDERED, shr::MessageHeader::MSG_TYPE_STATUS));
+    EXPECT_FALSE(shr::admits(Admission::DUPLICATE, shr::MessageHeader::MSG_TYPE_STATUS));
+}
+
+TEST(LinkReceiverTest, SequenceWrapsAround) {
+    shr::LinkReceiver link;
+    EXPECT_EQ(link.admit(0xFFFFFFFEu, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(0xFFFFFFFFu, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(1, 0, 0), Admission::NEW);
+    EXPECT_EQ(link.admit(0, 0, 0), Admission::REORDERED);
+    EXPECT_EQ(link.admit(0xFFFFFFFFu, 0, 0), Admission::DUPLICATE);
+    EXPECT_EQ(link.stats().lost, 0u);
+}
+
+TEST(LinkReceiverTest, StaleAndJitter) {
+    // Sender clock runs 5 s ahead of ours; only transit differences matter
+    constexpr uint32_t OFFSET = 5000000;
+    shr::LinkReceiver link(20000);
+    EXPECT_EQ(link.admit(1, OFFSET + 0, 1000), Admission::NEW);
+    EXPECT_EQ(link.admit(2, OFFSET + 10000, 11000), Admission::NEW);
+    // 30 ms longer in flight than the fastest datagram
+    EXPECT_EQ(link.admit(3, OFFSET + 20000, 51000), Admission::STALE);
+    EXPECT_EQ(link.admit(4, OFFSET + 60000, 61000), Admission::NEW);
+
+    shr::LinkStats stats = link.stats();
+    EXPECT_EQ(stats.stale, 1u);
+    EXPECT_EQ(stats.received, 4u);
+    // Two 30 ms transit swings: 30000/16, then 30000/16 + (30000 - that)/16
+    EXPECT_NEAR(stats.jitter_us, 1875.0 + (30000.0 - 1875.0) / 16.0, 1.0);
+}
+
+TEST(LinkReceiverTest, ClockDriftAndFastOutlierAgeOut) {
+    // Sender clock 100 ppm slow: transit grows 360 ms over the hour
+    shr::LinkReceiver link(100000);
+    uint32_t sequence = 0;
+    // One early datagram 200 ms faster than anything after it
+    EXPECT_EQ(link.admit(sequence++, 200000, 0), Admission::NEW);
+    size_t stale = 0;
+    for (uint64_t now = 10000; now < 3600ull * 1000000; now += 10000) {
+        uint32_t sender = static_cast<uint32_t>(now - now / 10000);
+        if (link.admit(sequence++, sender, now) == Admission::STALE)
+            ++stale;
+    }
+    // Only until the outlier leaves the window
+    EXPECT_LE(stale, 2 * shr::LinkReceiver::TRANSIT_WINDOW_US / 10000);
+    EXPECT_EQ(link.admit(sequence++, static_cast<uint32_t>(3600000000ull - 360000), 3600000000ull), Admission::NEW);
+
+    // A real delay is still caught
+    EXPECT_EQ(link.admit(sequence++, static_cast<uint32_t>(3600010000ull - 360001 - 150000), 3600010000ull), Admission::STALE);
+}
+
+TEST(LinkReceiverTest, PeerRestartResyncs) {
+    shr::LinkReceiver link(20000);
+    uint64_t now = 0;
+    for (uint32_t sequence = 0; sequence < 100000; ++sequence, now += 10000)
+        ASSERT_EQ(link.admit(sequence, static_cast<uint32_t>(now), now), Admission::NEW);
+
+    // Restarted peer: sequence and clock both from zero
+    size_t rejected = 0;
+    uint32_t sequence = 0;
+    for (; sequence < 100; ++sequence, now += 10000) {
+        Admission admission = link.admit(sequence, sequence * 10000, now);
+        if (admission != Admission::NEW) {
+            EXPECT_EQ(admission, Admission::TOO_OLD);
+            ++rejected;
+        } else {
+            break;
+        }
+    }
+    EXPECT_EQ(rejected, shr::LinkReceiver::RESYNC_RUN - 1);
+    for (++sequence, now += 10000; sequence < 200; ++sequence, now += 10000)
+        ASSERT_EQ(link.admit(sequence, sequence * 10000, now), Admission::NEW);
+    EXPECT_TRUE(shr::admits(link.admit(sequence, sequence * 10000, now), shr::MessageHeader::MSG_TYPE_ESTOP));
+
+    shr::LinkStats stats = link.stats();
+    EXPECT_EQ(stats.resyncs, 1u);
+    EXPECT_EQ(stats.stale, 0u);
+    EXPECT_EQ(stats.lost, 0u);
+}
+
+TEST(LinkReceiverTest, ReplayDoesNotResyncWhilePeerTalks) {
+    shr::LinkReceiver link;
+    uint32_t sequence = 0;
+    for (; sequence < 1000; ++sequence)
+        link.admit(sequence, sequence * 10000, sequence * 10000);
+
+    // Old datagrams replayed in between the live ones
+    for (uint32_t old = 100; old < 200; ++old, ++sequence) {
+        EXPECT_EQ(link.admit(old, old * 10000, sequence * 10000), Admission::TOO_OLD);
+        EXPECT_EQ(link.admit(sequence, sequence * 10000, sequence * 10000), Admission::NEW);
+    }
+    EXPECT_EQ(link.stats().resyncs, 0u);
+    EXPECT_EQ(link.stats().too_old, 100u);
+}
+
+TEST(LinkReceiverTest, HeaderCarriesSequenceAndTimestamp) {
+    shr::FrameEncoder encoder;
+    const uint8_t payload[] = {1, 2, 3};
+    std::vector<uint8_t> wire;
+    for (const auto &part : encoder.encode(shr::MessageHeader::MSG_TYPE_STATUS, shr::Integrity::CRC32C, payload, sizeof(payload), 0x01020304u, 0xA0B0C0D0u)) {
+        const auto *bytes = static_cast<const uint8_t *>(part.iov_base);
+        wire.insert(wire.end(), bytes, bytes + part.iov_len);
+    }
+    EXPECT_EQ(wire[shr::frame_offset::SEQUENCE], 0x04);
+    EXPECT_EQ(wire[shr::frame_offset::TIMESTAMP + 3], 0xA0);
+
+    shr::FrameView view;
+    ASSERT_EQ(shr::decodeFrame(wire.data(), wire.size(), view), shr::FrameError::NONE);
+    EXPECT_EQ(view.sequence, 0x01020304u);
+    EXPECT_EQ(view.timestamp_us, 0xA0B0C0D0u);
+}
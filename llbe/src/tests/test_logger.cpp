@@ -3,6 +3,8 @@
 #include <filesystem>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <nlohmann/json.hpp>
 #include "logger.hpp"
 
 class LoggerTest : public ::testing::Test {
@@ -84,7 +86,9 @@ TEST_F(LoggerTest, LogFormat) {
     // Read log file
     std::ifstream file(test_log_file_);
     std::string line;
-    std::getline(file, line);
+    // Skip the "Logger initialized" line
+    while (std::getline(file, line) && line.find("Test message") == std::string::npos) {
+    }
     
     // Check format: [timestamp] [level] message
     EXPECT_NE(line.find("["), std::string::npos);
@@ -178,3 +182,446 @@ TEST_F(LoggerTest, MacroUsage) {
     EXPECT_NE(content.find("Error macro"), std::string::npos);
     EXPECT_NE(content.find("Critical macro"), std::string::npos);
 }
+
+TEST_F(LoggerTest, AsyncLogging) {
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    async.queue_capacity = 64;
+    async.overflow = Logger::OverflowPolicy::BLOCK;
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+
+    const int num_threads = 4;
+    const int messages_per_thread = 500;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i, messages_per_thread]() {
+            for (int j = 0; j < messages_per_thread; ++j) {
+                Logger::getInstance().info("Thread " + std::to_string(i) + " Message " + std::to_string(j));
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    int line_count = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        line_count++;
+    }
+
+    // BLOCK policy never loses records; one extra line for initialization
+    EXPECT_EQ(line_count, num_threads * messages_per_thread + 1);
+    EXPECT_EQ(Logger::getInstance().droppedCount(), 0u);
+}
+
+TEST_F(LoggerTest, AsyncDropPolicy) {
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    async.queue_capacity = 4;
+    async.overflow = Logger::OverflowPolicy::DROP;
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+
+    uint64_t dropped_before = Logger::getInstance().droppedCount();
+    for (int j = 0; j < 10000; ++j) {
+        Logger::getInstance().info("Burst message " + std::to_string(j));
+    }
+    Logger::getInstance().flush();
+    Logger::getInstance().close();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    uint64_t dropped = Logger::getInstance().droppedCount() - dropped_before;
+    EXPECT_GT(dropped, 0u);
+    EXPECT_NE(content.find("Burst message 0"), std::string::npos);
+    EXPECT_NE(content.find("records (async queue full)"), std::string::npos);
+}
+
+TEST_F(LoggerTest, CategoryLevels) {
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::WARNING, false);
+    Logger::getInstance().setCategoryLevel(Logger::Category::TRUNK, Logger::Level::DEBUG);
+
+    EXPECT_TRUE(Logger::getInstance().isEnabled(Logger::Level::DEBUG, Logger::Category::TRUNK));
+    EXPECT_FALSE(Logger::getInstance().isEnabled(Logger::Level::INFO, Logger::Category::WEBRTC));
+
+    LOG_CAT_DEBUG(TRUNK, "Trunk debug");
+    LOG_CAT_INFO(WEBRTC, "WebRTC info");
+    LOG_CAT_WARNING(WEBRTC, "WebRTC warning");
+
+    // Global level changes leave the override alone
+    Logger::getInstance().setLevel(Logger::Level::ERROR);
+    LOG_CAT_DEBUG(TRUNK, "Trunk debug after setLevel");
+
+    Logger::getInstance().clearCategoryLevel(Logger::Category::TRUNK);
+    LOG_CAT_WARNING(TRUNK, "Trunk warning after clear");
+
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    EXPECT_NE(content.find("[trunk] Trunk debug"), std::string::npos);
+    EXPECT_EQ(content.find("WebRTC info"), std::string::npos);
+    EXPECT_NE(content.find("[webrtc] WebRTC warning"), std::string::npos);
+    EXPECT_NE(content.find("Trunk debug after setLevel"), std::string::npos);
+    EXPECT_EQ(content.find("Trunk warning after clear"), std::string::npos);
+}
+
+TEST_F(LoggerTest, LazyEvaluation) {
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+
+    int evaluations = 0;
+    auto build = [&evaluations]() {
+        ++evaluations;
+        return std::string("Expensive message");
+    };
+
+    LOG_DEBUG(build());
+    LOG_CAT_DEBUG(WEBRTC, build());
+    Logger::getInstance().log(Logger::Level::DEBUG, Logger::Category::GENERAL, build);
+    EXPECT_EQ(evaluations, 0);
+
+    LOG_INFO(build());
+    Logger::getInstance().log(Logger::Level::INFO, Logger::Category::GENERAL, build);
+    EXPECT_EQ(evaluations, 2);
+}
+
+TEST_F(LoggerTest, DeferredFormat) {
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+
+    std::string session = "abc123";
+    LOG_INFOF("Session {} sent {} bytes, ok={} ratio={} {{literal}}", session, 42u, true, 0.5);
+    LOG_CAT_WARNINGF(WEBRTC, "Negative {} char {}", -7, 'x');
+    LOG_INFOF("Missing {} {}", 1);
+    LOG_DEBUGF("Filtered {}", session);
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    EXPECT_NE(content.find("[INFO] Session abc123 sent 42 bytes, ok=true ratio=0.5 {literal}"), std::string::npos);
+    EXPECT_NE(content.find("[WARN] [webrtc] Negative -7 char x"), std::string::npos);
+    EXPECT_NE(content.find("Missing 1 {}"), std::string::npos);
+    EXPECT_EQ(content.find("Filtered"), std::string::npos);
+}
+
+TEST_F(LoggerTest, FormatFields) {
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+
+    std::string session = "abc123";
+    LOG_INFOF("Peer state {}", "connected", llbe::kv("session", session), llbe::kv("rtt_ms", 12));
+    LOG_INFOF("Quoted", llbe::kv("reason", std::string("ice failed")), llbe::kv("empty", ""));
+    LOG_INFOF("Unfilled {}", llbe::kv("k", 1));
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    EXPECT_NE(content.find("[INFO] Peer state connected session=abc123 rtt_ms=12\n"), std::string::npos);
+    EXPECT_NE(content.find("[INFO] Quoted reason=\"ice failed\" empty=\"\"\n"), std::string::npos);
+    EXPECT_NE(content.find("[INFO] Unfilled {} k=1\n"), std::string::npos);
+}
+
+TEST_F(LoggerTest, JsonFormat) {
+    Logger::getInstance().setFileFormat(Logger::FileFormat::JSON);
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+
+    LOG_CAT_INFOF(WEBRTC, "PeerConnection state {}", 3, llbe::kv("session", "abc123"), llbe::kv("ok", true));
+    LOG_WARNING("quote \" backslash \\ newline \n tab \t bell \a");
+    Logger::getInstance().close();
+    Logger::getInstance().setFileFormat(Logger::FileFormat::TEXT);
+
+    std::ifstream file(test_log_file_);
+    std::vector<nlohmann::json> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(nlohmann::json::parse(line));
+    }
+    ASSERT_EQ(lines.size(), 4u); // between the initialization and shutdown messages
+
+    const auto &state = lines[1];
+    EXPECT_EQ(state["level"], "INFO");
+    EXPECT_EQ(state["category"], "webrtc");
+    EXPECT_EQ(state["msg"], "PeerConnection state 3");
+    EXPECT_EQ(state["session"], "abc123");
+    EXPECT_EQ(state["ok"], true);
+    EXPECT_TRUE(state["thread"].is_number_unsigned());
+    EXPECT_TRUE(state["ts"].is_string());
+
+    EXPECT_EQ(lines[2]["level"], "WARN");
+    EXPECT_EQ(lines[2]["msg"], "quote \" backslash \\ newline \n tab \t bell \a");
+}
+
+TEST_F(LoggerTest, LongMessagesSpillToHeap) {
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+
+    // Longer than a record's inline buffer, as text and as encoded arguments
+    std::string big(1000, 'x');
+    LOG_INFO("text " + big);
+    LOG_INFOF("args {} {}", big, big);
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    EXPECT_NE(content.find("[INFO] text " + big + "\n"), std::string::npos);
+    EXPECT_NE(content.find("[INFO] args " + big + " " + big + "\n"), std::string::npos);
+}
+
+TEST_F(LoggerTest, BinaryFormat) {
+    Logger::getInstance().setFileFormat(Logger::FileFormat::BINARY);
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+
+    for (int i = 1; i <= 2; ++i) {
+        LOG_INFOF("Binary record {} of {}", i, 2);
+    }
+    Logger::getInstance().close();
+    Logger::getInstance().setFileFormat(Logger::FileFormat::TEXT);
+
+    std::ifstream file(test_log_file_, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    ASSERT_GE(content.size(), sizeof(llbe::logfmt::MAGIC));
+    EXPECT_EQ(content.compare(0, sizeof(llbe::logfmt::MAGIC),
+                              std::string(llbe::logfmt::MAGIC, sizeof(llbe::logfmt::MAGIC))), 0);
+
+    // The format string is stored once, the rendered text never is
+    size_t first = content.find("Binary record {} of {}");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_EQ(content.find("Binary record {} of {}", first + 1), std::string::npos);
+    EXPECT_EQ(content.find("Binary record 1 of 2"), std::string::npos);
+}
+
+TEST_F(LoggerTest, BinaryFormatMovesTextLogAside) {
+    {
+        std::ofstream old(test_log_file_);
+        old << "[INFO] from a text run\n";
+    }
+    Logger::getInstance().setFileFormat(Logger::FileFormat::BINARY);
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+    LOG_INFO("binary now");
+    Logger::getInstance().close();
+    Logger::getInstance().setFileFormat(Logger::FileFormat::TEXT);
+
+    std::ifstream file(test_log_file_, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_EQ(content.compare(0, sizeof(llbe::logfmt::MAGIC),
+                              std::string(llbe::logfmt::MAGIC, sizeof(llbe::logfmt::MAGIC))), 0);
+
+    // The text log is kept under an archive name
+    int moved = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(".")) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(test_log_file_ + ".", 0) == 0) {
+            std::ifstream aside(entry.path());
+            std::string line;
+            std::getline(aside, line);
+            EXPECT_EQ(line, "[INFO] from a text run");
+            std::filesystem::remove(entry.path());
+            ++moved;
+        }
+    }
+    EXPECT_EQ(moved, 1);
+}
+
+TEST_F(LoggerTest, RateLimit) {
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+    Logger::getInstance().setRateLimit(1.0, 5);
+    uint64_t limited_before = Logger::getInstance().stats().rate_limited;
+
+    for (int i = 0; i < 20; ++i) {
+        LOG_INFO("Noisy message " + std::to_string(i));
+        LOG_ERROR("Error message " + std::to_string(i));
+    }
+    Logger::getInstance().setRateLimit(0, 0);
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    // Only the burst gets through; errors are never limited
+    EXPECT_NE(content.find("Noisy message 4"), std::string::npos);
+    EXPECT_EQ(content.find("Noisy message 5"), std::string::npos);
+    EXPECT_NE(content.find("Error message 19"), std::string::npos);
+    EXPECT_EQ(Logger::getInstance().stats().rate_limited - limited_before, 15u);
+}
+
+TEST_F(LoggerTest, CollapseDuplicates) {
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false);
+    Logger::getInstance().setCollapseDuplicates(true);
+    uint64_t collapsed_before = Logger::getInstance().stats().collapsed;
+
+    for (int i = 0; i < 10; ++i) {
+        Logger::getInstance().info("Same message");
+    }
+    Logger::getInstance().info("Different message");
+    Logger::getInstance().flush();
+    Logger::getInstance().setCollapseDuplicates(false);
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+
+    size_t first = content.find("Same message");
+    EXPECT_NE(first, std::string::npos);
+    EXPECT_EQ(content.find("Same message", first + 1), std::string::npos);
+    size_t repeated = content.find("last message repeated 9 times");
+    EXPECT_NE(repeated, std::string::npos);
+    EXPECT_LT(repeated, content.find("Different message"));
+    EXPECT_EQ(Logger::getInstance().stats().collapsed - collapsed_before, 9u);
+}
+
+TEST_F(LoggerTest, Rotation) {
+    std::filesystem::path dir = "test_log_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    std::string log_file = (dir / "rotate.log").string();
+
+    Logger::RotationOptions rotation;
+    rotation.max_bytes = 1024;
+    rotation.preallocate_bytes = 1024;
+    rotation.max_files = 3;
+    rotation.compress = true;
+    Logger::getInstance().setRotation(rotation);
+    Logger::getInstance().initialize(log_file, Logger::Level::INFO, false);
+
+    for (int i = 0; i < 200; ++i) {
+        Logger::getInstance().info("Rotation test message " + std::to_string(i));
+    }
+    // Waits for the archiver to finish
+    Logger::getInstance().close();
+    Logger::getInstance().setRotation(Logger::RotationOptions());
+
+    size_t archives = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        if (name != "rotate.log") {
+            EXPECT_EQ(name.rfind("rotate.log.", 0), 0u) << name;
+            ++archives;
+        }
+    }
+    EXPECT_EQ(archives, 3u);
+
+    // The active segment holds the newest lines and stays under the limit
+    std::ifstream file(log_file);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("Logger shutting down"), std::string::npos);
+    EXPECT_LT(content.size(), 1024u + 128u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(LoggerTest, FlightRecorder) {
+    std::string recorder_file = "test_flight.rec";
+    ASSERT_TRUE(Logger::getInstance().openFlightRecorder(recorder_file, 64, Logger::Level::DEBUG));
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::WARNING, false);
+
+    LOG_DEBUG("Recorded debug context");
+    LOG_DEBUGF("Recorded value {}", 42);
+    LOG_WARNING("Logged warning");
+    Logger::getInstance().flush();
+
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_EQ(content.find("Recorded debug context"), std::string::npos);
+    EXPECT_NE(content.find("Logged warning"), std::string::npos);
+
+    // Read back from the file while the mapping is still live
+    llbe::FlightRecorder::Header header{};
+    std::vector<llbe::FlightRecorder::Entry> entries;
+    ASSERT_TRUE(llbe::FlightRecorder::load(recorder_file, header, entries));
+    EXPECT_EQ(header.slot_count, 64u);
+
+    std::vector<std::string> texts;
+    for (const auto &entry : entries) {
+        texts.push_back(entry.text);
+    }
+    auto debug = std::find(texts.begin(), texts.end(), "Recorded debug context");
+    ASSERT_NE(debug, texts.end());
+    EXPECT_EQ(*(debug + 1), "Recorded value 42");
+    EXPECT_EQ(*(debug + 2), "Logged warning");
+
+    std::filesystem::remove(recorder_file);
+}
+
+TEST_F(LoggerTest, FlightRecorderWraps) {
+    std::string recorder_file = "test_flight_wrap.rec";
+    {
+        llbe::FlightRecorder recorder;
+        ASSERT_TRUE(recorder.open(recorder_file, 8, 0));
+        for (int i = 0; i < 20; ++i) {
+            recorder.record(i, 1, 0, "record " + std::to_string(i));
+        }
+    }
+
+    llbe::FlightRecorder::Header header{};
+    std::vector<llbe::FlightRecorder::Entry> entries;
+    ASSERT_TRUE(llbe::FlightRecorder::load(recorder_file, header, entries));
+    ASSERT_EQ(entries.size(), 8u);
+    EXPECT_EQ(entries.front().text, "record 12");
+    EXPECT_EQ(entries.back().text, "record 19");
+    EXPECT_EQ(entries.back().seq, 19u);
+
+    std::filesystem::remove(recorder_file);
+}
+
+TEST_F(LoggerTest, AsyncSinkLatencyBound) {
+    llbe::LogSink::Options sink_options;
+    sink_options.flush_bytes = 1 << 20;
+    sink_options.flush_interval = std::chrono::milliseconds(5);
+    Logger::getInstance().setSinkOptions(sink_options);
+
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+    Logger::getInstance().info("Latency bound message");
+
+    // No flush(): the writer must still write the staged bytes on its own
+    std::string content;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (content.find("Latency bound message") == std::string::npos &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::ifstream file(test_log_file_);
+        content.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+    EXPECT_NE(content.find("Latency bound message"), std::string::npos);
+
+    Logger::getInstance().close();
+    Logger::getInstance().setSinkOptions(llbe::LogSink::Options());
+}
+
+TEST_F(LoggerTest, SyncCritical) {
+    Logger::AsyncOptions async;
+    async.enabled = true;
+    Logger::getInstance().setSyncCritical(true);
+    Logger::getInstance().initialize(test_log_file_, Logger::Level::INFO, false, async);
+
+    LOG_CRITICAL("Durable critical message");
+
+    // Returned only after the writer wrote and synced it
+    std::ifstream file(test_log_file_);
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    EXPECT_NE(content.find("Durable critical message"), std::string::npos);
+    Logger::getInstance().setSyncCritical(false);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include "messages.hpp"
+
+namespace {
+    struct RecordingHandler {
+        int heartbeats = 0;
+        int commands = 0;
+        int estops = 0;
+        std::string log;
+        size_t status_bytes = 0;
+        shr::DriveCommandPayload last_command{};
+
+        void operator()(shr::LogMessage, std::span<const uint8_t> text) {
+            log.assign(reinterpret_cast<const char *>(text.data()), text.size());
+        }
+        void operator()(shr::HeartbeatMessage, const shr::HeartbeatPayload &) { ++heartbeats; }
+        void operator()(shr::CommandMessage, const shr::DriveCommandPayload &command) {
+            ++commands;
+            last_command = command;
+        }
+        void operator()(shr::StatusMessage, std::span<const uint8_t> status) { status_bytes += status.size(); }
+        void operator()(shr::EstopMessage, const shr::EstopPayload &) { ++estops; }
+    };
+
+    // Generic fallback overloads also satisfy the completeness check
+    struct CountingHandler {
+        int calls = 0;
+        template <typename Type, typename Payload>
+        void operator()(Type, const Payload &) { ++calls; }
+    };
+}
+
+TEST(RegistryTest, DispatchesByTypeId) {
+    RecordingHandler handler;
+
+    shr::DriveCommandPayload command{250, -250};
+    uint8_t wire[sizeof(command) + 1];
+    // Odd offset: the payload is not aligned in the receive buffer
+    std::memcpy(wire + 1, &command, sizeof(command));
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_COMMAND, wire + 1, sizeof(command), handler),
+              shr::DispatchResult::HANDLED);
+    EXPECT_EQ(handler.commands, 1);
+    EXPECT_EQ(handler.last_command.left_mm_s, 250);
+    EXPECT_EQ(handler.last_command.right_mm_s, -250);
+
+    const std::string text = "motor 1 over temperature";
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_LOG,
+                                           reinterpret_cast<const uint8_t *>(text.data()), text.size(), handler),
+              shr::DispatchResult::HANDLED);
+    EXPECT_EQ(handler.log, text);
+
+    shr::HeartbeatPayload heartbeat{7, 1000};
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_HEARTBEAT,
+                                           reinterpret_cast<const uint8_t *>(&heartbeat), sizeof(heartbeat), handler),
+              shr::DispatchResult::HANDLED);
+    EXPECT_EQ(handler.heartbeats, 1);
+}
+
+TEST(RegistryTest, RejectsUnknownTypesAndBadLengths) {
+    RecordingHandler handler;
+    uint8_t bytes[16] = {};
+
+    EXPECT_EQ(shr::RobotMessages::dispatch(5, bytes, 0, handler), shr::DispatchResult::UNKNOWN_TYPE);
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_UNDEFINED, bytes, 0, handler), shr::DispatchResult::UNKNOWN_TYPE);
+    EXPECT_EQ(shr::RobotMessages::dispatch(255, bytes, 0, handler), shr::DispatchResult::UNKNOWN_TYPE);
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_ESTOP, bytes, 3, handler), shr::DispatchResult::BAD_LENGTH);
+    EXPECT_EQ(handler.estops, 0);
+
+    // Variable-length types accept any length, including none
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_STATUS, bytes, 0, handler), shr::DispatchResult::HANDLED);
+
+    static_assert(shr::RobotMessages::contains(shr::MessageHeader::MSG_TYPE_ESTOP));
+    static_assert(!shr::RobotMessages::contains(5));
+}
+
+TEST(RegistryTest, GenericHandler) {
+    CountingHandler handler;
+    shr::EstopPayload estop{1, 0};
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_ESTOP,
+                                           reinterpret_cast<const uint8_t *>(&estop), sizeof(estop), handler),
+              shr::DispatchResult::HANDLED);
+    EXPECT_EQ(shr::RobotMessages::dispatch(shr::MessageHeader::MSG_TYPE_LOG, nullptr, 0, handler),
+              shr::DispatchResult::HANDLED);
+    EXPECT_EQ(handler.calls, 2);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "status.hpp"
+
+namespace {
+    shr::RobotStatus sampleStatus() {
+        shr::RobotStatus status;
+        status.drivers_active = 4;
+        status.communication_errors = 17;
+        for (size_t i = 0; i < shr::STATUS_MOTOR_COUNT; ++i) {
+            status.motors[i].flags = shr::MOTOR_FLAG_STEALTH_ACTIVE;
+            status.motors[i].stallguard_result = static_cast<uint16_t>(300 + i);
+            status.motors[i].cs_actual = 20;
+        }
+        status.power = {12150, 4200, 1750, 21262, 3412};
+        return status;
+    }
+}
+
+TEST(StatusCodecTest, KeyframeThenDeltas) {
+    shr::StatusEncoder encoder(4);
+    shr::StatusDecoder decoder;
+    shr::RobotStatus status = sampleStatus();
+    uint8_t buf[shr::STATUS_MAX_SIZE];
+
+    size_t key_len = encoder.encode(status, buf);
+    EXPECT_EQ(buf[0], shr::STATUS_KEYFRAME);
+    shr::RobotStatus out;
+    ASSERT_EQ(decoder.decode(buf, key_len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+
+    // Unchanged: kind, id and an empty mask
+    size_t len = encoder.encode(status, buf);
+    EXPECT_EQ(buf[0], shr::STATUS_DELTA);
+    EXPECT_EQ(len, 2 + shr::STATUS_MASK_BYTES);
+    ASSERT_EQ(decoder.decode(buf, len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+
+    // Typical update: current, power and one stallguard reading move a little
+    status.power.current_ma -= 12;
+    status.power.power_mw -= 146;
+    status.motors[2].stallguard_result += 3;
+    status.motors[0].flags |= shr::MOTOR_FLAG_STST;
+    len = encoder.encode(status, buf);
+    EXPECT_LT(len, key_len / 2);
+    ASSERT_EQ(decoder.decode(buf, len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+
+    // Signed readings crossing zero and a wrapping counter
+    status.power.current_ma = -40;
+    status.communication_errors = 0xFFFFFFFFu;
+    len = encoder.encode(status, buf);
+    ASSERT_EQ(decoder.decode(buf, len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+
+    // Interval of 4: the fifth is a keyframe again
+    len = encoder.encode(status, buf);
+    EXPECT_EQ(buf[0], shr::STATUS_KEYFRAME);
+    ASSERT_EQ(decoder.decode(buf, len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+}
+
+TEST(StatusCodecTest, DeltaNeedsItsKeyframe) {
+    shr::StatusEncoder encoder;
+    shr::StatusDecoder decoder;
+    shr::RobotStatus status = sampleStatus();
+    uint8_t key[shr::STATUS_MAX_SIZE];
+    uint8_t delta[shr::STATUS_MAX_SIZE];
+    shr::RobotStatus out;
+
+    size_t key_len = encoder.encode(status, key);
+    status.power.bus_voltage_mv -= 5;
+    size_t delta_len = encoder.encode(status, delta);
+
+    // Keyframe lost
+    EXPECT_EQ(decoder.decode(delta, delta_len, out), shr::StatusError::NO_KEYFRAME);
+    ASSERT_EQ(decoder.decode(key, key_len, out), shr::StatusError::NONE);
+    ASSERT_EQ(decoder.decode(delta, delta_len, out), shr::StatusError::NONE);
+    EXPECT_EQ(out, status);
+
+    // Delta from an older keyframe after a new one
+    encoder.forceKeyframe();
+    key_len = encoder.encode(status, key);
+    ASSERT_EQ(key[0], shr::STATUS_KEYFRAME);
+    ASSERT_EQ(decoder.decode(key, key_len, out), shr::StatusError::NONE);
+    EXPECT_EQ(decoder.decode(delta, delta_len, out), shr::StatusError::NO_KEYFRAME);
+}
+
+TEST(StatusCodecTest, RejectsMalformed) {
+    shr::StatusEncoder encoder;
+    shr::StatusDecoder decoder;
+    uint8_t buf[shr::STATUS_MAX_SIZE];
+    shr::RobotStatus out;
+    size_t len = encoder.encode(sampleStatus(), buf);
+
+    EXPECT_EQ(decoder.decode(buf, 1, out), shr::StatusError::TRUNCATED);
+    EXPECT_EQ(decoder.decode(buf, len - 1, out), shr::StatusError::TRUNCATED);
+    buf[len] = 0;
+    EXPECT_EQ(decoder.decode(buf, len + 1, out), shr::StatusError::MALFORMED);
+
+    uint8_t bad_kind[] = {9, 1};
+    EXPECT_EQ(decoder.decode(bad_kind, sizeof(bad_kind), out), shr::StatusError::BAD_KIND);
+
+    uint8_t long_varint[shr::STATUS_MAX_SIZE] = {shr::STATUS_KEYFRAME, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    EXPECT_EQ(decoder.decode(long_varint, 8, out), shr::StatusError::MALFORMED);
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "timestamp.hpp"
+
+using llbe::TimestampFormatter;
+
+namespace {
+    // 2025-01-31 13:37:00.123456789 UTC
+    constexpr int64_t STAMP_NS = 1738330620123456789LL;
+}
+
+TEST(TimestampTest, UtcFormat) {
+    TimestampFormatter formatter(TimestampFormatter::Mode::UTC);
+    EXPECT_EQ(formatter.toString(STAMP_NS), "2025-01-31T13:37:00.123Z");
+
+    // Same second reuses the cached prefix, only the milliseconds change
+    EXPECT_EQ(formatter.toString(STAMP_NS + 500000000LL), "2025-01-31T13:37:00.623Z");
+    EXPECT_EQ(formatter.toString(STAMP_NS + 1000000000LL), "2025-01-31T13:37:01.123Z");
+}
+
+TEST(TimestampTest, EpochAndMonotonicFormat) {
+    TimestampFormatter epoch(TimestampFormatter::Mode::EPOCH_US);
+    EXPECT_EQ(epoch.toString(STAMP_NS), "1738330620123456");
+
+    TimestampFormatter monotonic(TimestampFormatter::Mode::MONOTONIC);
+    EXPECT_EQ(monotonic.toString(12345678901234LL), "12345.678901");
+    EXPECT_EQ(monotonic.toString(5000LL), "0.000005");
+}
+
+TEST(TimestampTest, LocalFormatShape) {
+    TimestampFormatter formatter(TimestampFormatter::Mode::LOCAL);
+    std::string stamp = formatter.toString(formatter.now());
+
+    // YYYY-MM-DD HH:MM:SS.mmm
+    ASSERT_EQ(stamp.size(), 23u);
+    EXPECT_EQ(stamp[4], '-');
+    EXPECT_EQ(stamp[10], ' ');
+    EXPECT_EQ(stamp[19], '.');
+}
+
+TEST(TimestampTest, ModeFromString) {
+    TimestampFormatter::Mode mode;
+    EXPECT_TRUE(TimestampFormatter::modeFromString("monotonic", mode));
+    EXPECT_EQ(mode, TimestampFormatter::Mode::MONOTONIC);
+    EXPECT_FALSE(TimestampFormatter::modeFromString("bogus", mode));
+}
@@ -0,0 +1,56 @@
+/**
+ * flightdump.cpp
+ *
+ * Prints the records held by an LLBE flight recorder file
+ * (logging.flight_recorder), oldest first, as "[ts] [LEVEL] msg" lines
+ * tagged with the writing thread id.
+ *
+ * Usage: flightdump <file>   (after a restart the crashed run is <file>.prev)
+ */
+
+#include "flight_recorder.hpp"
+#include "logger.hpp"
+#include "timestamp.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <file>\n";
+    return 1;
+  }
+
+  llbe::FlightRecorder::Header header{};
+  std::vector<llbe::FlightRecorder::Entry> entries;
+  if (!llbe::FlightRecorder::load(argv[1], header, entries))
+  {
+    std::cerr << "Could not read flight recorder file " << argv[1] << "\n";
+    return 1;
+  }
+
+  llbe::TimestampFormatter timestamps(static_cast<llbe::TimestampFormatter::Mode>(header.timestamp_mode));
+  std::cout << "# " << entries.size() << " records, " << header.slot_count << " slots\n";
+
+  std::string line;
+  uint64_t expected = entries.empty() ? 0 : entries.front().seq;
+  for (const auto &entry : entries)
+  {
+    if (entry.seq != expected)
+    {
+      std::cout << "# " << entry.seq - expected << " records missing (torn or overwritten)\n";
+    }
+    expected = entry.seq + 1;
+
+    line.clear();
+    Logger::appendTextLine(line, timestamps, static_cast<Logger::Level>(entry.level),
+      static_cast<Logger::Category>(entry.category), entry.time, nullptr,
+      "[tid " + std::to_string(entry.thread) + "] " + entry.text);
+    std::cout << line;
+  }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * logdecode.cpp
+ *
+ * Renders a binary LLBE log (logging.format = "binary") as the usual
+ * "[ts] [LEVEL] msg" text lines.
+ *
+ * Usage: logdecode <file>   (use "-" to read stdin)
+ */
+
+#include "logger.hpp"
+#include "log_format.hpp"
+#include "timestamp.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+  using namespace llbe::logfmt;
+
+  bool decode(const std::string &data)
+  {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data.data());
+    size_t len = data.size();
+    size_t pos = 0;
+
+    if (len < sizeof(MAGIC) || std::memcmp(p, MAGIC, sizeof(MAGIC)) != 0)
+    {
+      std::cerr << "Not a binary LLBE log (bad magic)\n";
+      return false;
+    }
+    pos += sizeof(MAGIC);
+
+    llbe::TimestampFormatter timestamps;
+    std::unordered_map<uint32_t, std::string> formats;
+    std::string line;
+
+    while (pos < len)
+    {
+      uint8_t tag = p[pos++];
+      if (tag == TAG_SESSION)
+      {
+        if (len - pos < 2)
+          break;
+        if (p[pos] != BINARY_VERSION)
+        {
+          std::cerr << "Unsupported binary log version " << int(p[pos]) << "\n";
+          return false;
+        }
+        timestamps.setMode(static_cast<llbe::TimestampFormatter::Mode>(p[pos + 1]));
+        formats.clear();
+        pos += 2;
+      }
+      else if (tag == TAG_FORMAT)
+      {
+        if (len - pos < 6)
+          break;
+        uint32_t id = getLE<uint32_t>(p + pos);
+        uint16_t n = getLE<uint16_t>(p + pos + 4);
+        pos += 6;
+        if (len - pos < n)
+          break;
+        formats[id].assign(reinterpret_cast<const char *>(p + pos), n);
+        pos += n;
+      }
+      else if (tag == TAG_RECORD)
+      {
+        if (len - pos < 18)
+          break;
+        auto level = static_cast<Logger::Level>(p[pos]);
+        auto category = static_cast<Logger::Category>(p[pos + 1]);
+        int64_t time = getLE<int64_t>(p + pos + 2);
+        uint32_t id = getLE<uint32_t>(p + pos + 10);
+        uint32_t n = getLE<uint32_t>(p + pos + 14);
+        pos += 18;
+        if (len - pos < n)
+          break;
+
+        const char *format = nullptr;
+        if (id != RAW_TEXT)
+        {
+          auto it = formats.find(id);
+          format = it != formats.end() ? it->second.c_str() : "<unknown format> {}";
+        }
+
+        line.clear();
+        Logger::appendTextLine(line, timestamps, level, category, time, format,
+          std::string_view(reinterpret_cast<const char *>(p + pos), n));
+        std::cout << line;
+        pos += n;
+      }
+      else
+      {
+        std::cerr << "Corrupt entry (tag " << int(tag) << ") at offset " << pos - 1 << "\n";
+        return false;
+      }
+    }
+
+    if (pos < len)
+    {
+      std::cerr << "Truncated entry at end of file\n";
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <file|->\n";
+    return 1;
+  }
+
+  std::string data;
+  if (std::string(argv[1]) == "-")
+  {
+    data.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+  }
+  else
+  {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open())
+    {
+      std::cerr << "Could not open " << argv[1] << "\n";
+      return 1;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  return decode(data) ? 0 : 1;
+}
@@ -10,6 +10,7 @@
  */
 
 #include <arpa/inet.h>
+#include <array>
 #include <chrono>
 #include <csignal>
 #include <cstring>
@@ -394,6 +395,9 @@ int main(int argc, char **argv)
 
     // Null-terminate payload for printing (careful: message may contain NULs)
     size_t printed_len = (n >= 0 && n < sizeof(iov_recvbuf)) ? n : (sizeof(iov_recvbuf) - 1);
+    // Senders may or may not end the line; we add our own
+    while (printed_len > 0 && (iov_recvbuf[printed_len - 1] == '\n' || iov_recvbuf[printed_len - 1] == '\r'))
+      --printed_len;
     iov_recvbuf[printed_len] = '\0';
 
     // Timestamp
@@ -405,7 +409,7 @@ int main(int argc, char **argv)
         << " [d=" << (have_dst ? dst_ip_str : "?") << ":" << dst_port << ""
         << " s=" << src_ip_str << ":" << src_port << ""
         << " m=" << src_mac_str << "] "
-        << 'msg=' << iov_recvbuf;
+        << "msg=" << iov_recvbuf;
 
     std::cout << oss.str() << std::endl;
   }
@@ -0,0 +1,239 @@
+#ifndef SHAREDCPP_INCLUDE_BUNDLE_HPP
+#define SHAREDCPP_INCLUDE_BUNDLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "framing.hpp"
+
+/**
+ * Several small messages coalesced into one datagram.
+ *
+ * A bundle is an ordinary frame (framing.hpp) of type MSG_TYPE_BUNDLE whose
+ * payload is a run of entries, protected by the frame's one trailer:
+ *
+ *   offset  size  field
+ *   0       1     message type of the entry
+ *   1       2     entry length, little-endian
+ *   3       n     entry payload
+ *
+ * At heartbeat/command/status/log rates this turns many tiny datagrams,
+ * each with its own header and trailer, into a few full ones: less WiFi
+ * airtime per message and fewer sendmsg calls.
+ */
+namespace shr
+{
+  constexpr size_t BUNDLE_ENTRY_HEADER_SIZE = 3;
+
+  // 1500-byte Ethernet/WiFi MTU minus IPv4 and UDP headers
+  constexpr size_t DEFAULT_BUNDLE_MTU = 1472;
+
+  /**
+   * @return true if a bundle protected by `have` is good enough for an
+   *         entry whose type requires `need` (NONE < CRC32C < SHA256 < HMAC)
+   */
+  constexpr bool integrityCovers(Integrity have, Integrity need)
+  {
+    auto rank = [](Integrity mode) {
+      switch (mode)
+      {
+      case Integrity::NONE:
+        return 0;
+      case Integrity::CRC32C:
+        return 1;
+      case Integrity::SHA256:
+        return 2;
+      case Integrity::HMAC_SHA256_128:
+        return 3;
+      }
+      return 0;
+    };
+    return rank(have) >= rank(need);
+  }
+
+  /**
+   * Packs messages into one datagram of at most mtu bytes. Payloads are
+   * copied into a buffer allocated once, at construction.
+   *
+   *   if (!bundle.add(type, payload, len)) { send(bundle.finish(seq++, now_us)); bundle.clear(); bundle.add(...); }
+   */
+  class BundleEncoder
+  {
+  public:
+    /**
+     * @param mtu largest datagram, header and trailer included; clamped to
+     *        the largest frame, FRAME_MAX_PAYLOAD bytes of entries
+     * @param mode integrity of the whole bundle; must cover every entry
+     */
+    BundleEncoder(size_t mtu = DEFAULT_BUNDLE_MTU, Integrity mode = Integrity::CRC32C)
+      : mtu_(clampMtu(mtu, mode)), mode_(mode), buffer_(clampMtu(mtu, mode) + FRAME_MAX_TRAILER)
+    {
+      clear();
+    }
+
+    /**
+     * Append a message
+     * @return false if it does not fit in what is left of the mtu (or in an
+     *         empty bundle at all); the bundle is unchanged
+     */
+    bool add(uint8_t message_type, const uint8_t* payload, size_t len)
+    {
+      if (!fits(len))
+        return false;
+      uint8_t* entry = buffer_.data() + used_;
+      entry[0] = message_type;
+      storeLe16(entry + 1, static_cast<uint16_t>(len));
+      if (len > 0)
+        std::memcpy(entry + BUNDLE_ENTRY_HEADER_SIZE, payload, len);
+      used_ += BUNDLE_ENTRY_HEADER_SIZE + len;
+      ++count_;
+      return true;
+    }
+
+    /**
+     * @return true if a len-byte message still fits
+     */
+    inline bool fits(size_t len) const
+    {
+      return used_ + BUNDLE_ENTRY_HEADER_SIZE + len + integrityTagSize(mode_) <= mtu_;
+    }
+
+    /**
+     * @return largest message an empty bundle can take
+     */
+    inline size_t maxEntry() const
+    {
+      size_t overhead = FRAME_HEADER_SIZE + BUNDLE_ENTRY_HEADER_SIZE + integrityTagSize(mode_);
+      return mtu_ > overhead ? mtu_ - overhead : 0;
+    }
+
+    inline size_t mtu() const { return mtu_; }
+    inline size_t count() const { return count_; }
+    inline bool empty() const { return count_ == 0; }
+    inline Integrity integrity() const { return mode_; }
+
+    /**
+     * Write the header and trailer
+     * @param sequence next sequence number on the link
+     * @param timestamp_us sender's monotonic clock in microseconds
+     * @return the datagram, valid until the next add() or clear(); empty if
+     *         the mode needs a key that is not set
+     */
+    std::span<const uint8_t> finish(uint32_t sequence = 0, uint32_t timestamp_us = 0)
+    {
+      uint8_t* header = buffer_.data();
+      header[frame_offset::VERSION] = MessageHeader::CURRENT_VERSION;
+      header[frame_offset::MESSAGE_TYPE] = MessageHeader::MSG_TYPE_BUNDLE;
+      storeLe16(header + frame_offset::LENGTH, static_cast<uint16_t>(used_ - FRAME_HEADER_SIZE));
+      header[frame_offset::INTEGRITY] = static_cast<uint8_t>(mode_);
+      storeLe32(header + frame_offset::SEQUENCE, sequence);
+      storeLe32(header + frame_offset::TIMESTAMP, timestamp_us);
+
+      struct iovec iov = {header, used_};
+      uint8_t tag[FRAME_MAX_TRAILER];
+      if (!computeTag(mode_, &iov, 1, tag))
+        return {};
+      size_t tag_size = integrityTagSize(mode_);
+      std::memcpy(buffer_.data() + used_, tag, tag_size);
+      return {buffer_.data(), used_ + tag_size};
+    }
+
+    /**
+     * Start a new bundle
+     */
+    inline void clear()
+    {
+      used_ = FRAME_HEADER_SIZE;
+      count_ = 0;
+    }
+
+  private:
+    // The length field is 16 bits
+    static constexpr size_t clampMtu(size_t mtu, Integrity mode)
+    {
+      size_t largest = FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + integrityTagSize(mode);
+      return mtu < largest ? mtu : largest;
+    }
+
+    size_t mtu_;
+    Integrity mode_;
+    std::vector<uint8_t> buffer_; // header, entries, then room for the trailer
+    size_t used_;                 // header + entries
+    size_t count_;
+  };
+
+  /**
+   * One message inside a received datagram; points into the receive buffer
+   */
+  struct SubMessage
+  {
+    uint8_t message_type = MessageHeader::MSG_TYPE_UNDEFINED;
+    const uint8_t* payload = nullptr;
+    size_t length = 0;
+  };
+
+  /**
+   * Iterates the messages of a verified frame in place. A plain frame
+   * yields itself once; a bundle yields each entry.
+   *
+   *   BundleReader reader(view);
+   *   for (SubMessage msg; reader.next(msg);) { ... }
+   *   if (reader.malformed()) { ... }
+   */
+  class BundleReader
+  {
+  public:
+    explicit BundleReader(const FrameView& frame) : frame_(frame) {}
+
+    /**
+     * @param out next message
+     * @return false when done, or when the bundle is malformed
+     */
+    bool next(SubMessage& out)
+    {
+      if (frame_.message_type != MessageHeader::MSG_TYPE_BUNDLE)
+      {
+        if (single_done_)
+          return false;
+        single_done_ = true;
+        out = SubMessage{frame_.message_type, frame_.payload, frame_.payload_length};
+        return true;
+      }
+
+      size_t left = frame_.payload_length - offset_;
+      if (left == 0)
+        return false;
+      const uint8_t* entry = frame_.payload + offset_;
+      if (left < BUNDLE_ENTRY_HEADER_SIZE)
+      {
+        malformed_ = true;
+        return false;
+      }
+      size_t len = loadLe16(entry + 1);
+      if (len > left - BUNDLE_ENTRY_HEADER_SIZE || entry[0] == MessageHeader::MSG_TYPE_BUNDLE)
+      {
+        malformed_ = true; // overruns the bundle, or nests one
+        return false;
+      }
+      offset_ += BUNDLE_ENTRY_HEADER_SIZE + len;
+      out = SubMessage{entry[0], entry + BUNDLE_ENTRY_HEADER_SIZE, len};
+      return true;
+    }
+
+    /**
+     * @return true if iteration stopped on a bad entry
+     */
+    inline bool malformed() const { return malformed_; }
+
+  private:
+    FrameView frame_;
+    size_t offset_ = 0;
+    bool single_done_ = false; // plain frame already yielded (it may be empty)
+    bool malformed_ = false;
+  };
+}
+
+#endif // SHAREDCPP_INCLUDE_BUNDLE_HPP
@@ -1,7 +1,9 @@
 #ifndef SHARED_CPP_INCLUDE_CRYPTO_HPP
 #define SHARED_CPP_INCLUDE_CRYPTO_HPP
 
+#include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 namespace crypto
 {
@@ -10,6 +12,129 @@ namespace crypto
   // 9000-14B for jumbo frames
   extern void sha256_hash(const uint8_t* data, int len, uint8_t out[32]);
   extern bool sha256_verify(const uint8_t* data, int len, const uint8_t expected[32]);
+
+  /**
+   * Hash the concatenation of iovcnt buffers without copying them together
+   * (e.g. header, payload and trailer of a message)
+   * @param iov buffers, hashed in order
+   * @param iovcnt number of buffers
+   * @param out digest
+   */
+  extern void sha256_hash(const struct iovec* iov, int iovcnt, uint8_t out[32]);
+
+  struct Sha256VerifyJob
+  {
+    const uint8_t* data;
+    int len;
+    const uint8_t* expected; // 32-byte digest
+  };
+
+  /**
+   * Verify up to 64 independent messages at once. Messages are hashed side
+   * by side in SIMD lanes (16 with AVX-512, 8 with AVX2, 4 otherwise) when
+   * that beats the single-message kernel on this CPU.
+   * @param jobs messages and their expected digests
+   * @param count number of jobs; jobs past the 64th are not checked
+   * @return bit i set if jobs[i] matches its digest
+   */
+  extern uint64_t sha256_verify_batch(const Sha256VerifyJob* jobs, int count);
+
+  /**
+   * Incremental SHA-256. Whole blocks are compressed straight from the
+   * caller's buffers; only a partial block is copied into the context, and
+   * only the final block is padded. No heap allocation.
+   *
+   *   crypto::Sha256 ctx;
+   *   ctx.update(header, sizeof(header));
+   *   ctx.update(payload, payload_len);
+   *   ctx.final(digest);
+   */
+  class Sha256
+  {
+  public:
+    // Compress n consecutive 64-byte blocks into state
+    using BlockFn = void (*)(uint32_t state[8], const uint8_t* blocks, size_t n);
+
+    /**
+     * Uses the fastest compression kernel this CPU supports
+     */
+    Sha256();
+
+    /**
+     * @param blocks compression kernel to use (tests, benchmarks)
+     */
+    explicit Sha256(BlockFn blocks);
+
+    /**
+     * Start a new message. Called by the constructors and by final().
+     */
+    void init();
+
+    void update(const uint8_t* data, size_t len);
+
+    /**
+     * Pad, write the digest and reset the context for the next message
+     * @param out digest
+     */
+    void final(uint8_t out[32]);
+
+  private:
+    BlockFn blocks_;
+    uint32_t state_[8];
+    uint64_t length_;    // message bytes so far
+    size_t buffered_;    // bytes in buffer_
+    uint8_t buffer_[64]; // partial block
+  };
+
+  /**
+   * HMAC-SHA256 key. The padded key blocks are compressed once here, so
+   * each mac() only hashes the message.
+   */
+  class HmacSha256Key
+  {
+  public:
+    HmacSha256Key() = default;
+    HmacSha256Key(const uint8_t* key, size_t len);
+
+    void set(const uint8_t* key, size_t len);
+
+    /**
+     * @return true once a key has been set
+     */
+    inline bool isSet() const { return set_; }
+
+    /**
+     * @param data message
+     * @param len message length in bytes
+     * @param out full 32-byte MAC; truncate by comparing a prefix
+     */
+    void mac(const uint8_t* data, size_t len, uint8_t out[32]) const;
+
+    /**
+     * MAC over the concatenation of iovcnt buffers
+     */
+    void mac(const struct iovec* iov, int iovcnt, uint8_t out[32]) const;
+
+  private:
+    Sha256 inner_; // state after the ipad block
+    Sha256 outer_; // state after the opad block
+    bool set_ = false;
+  };
+
+  /**
+   * CRC32C (Castagnoli), hardware-accelerated where available
+   * @param data bytes
+   * @param len number of bytes
+   * @param crc result of the previous call when checksumming in pieces
+   * @return checksum
+   */
+  extern uint32_t crc32c(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+  /**
+   * Constant-time comparison for digests and MACs
+   * @return true if the n bytes are equal
+   */
+  extern bool ct_equal(const uint8_t* a, const uint8_t* b, size_t n);
 }
 
 #endif // SHARED_CPP_INCLUDE_CRYPTO_HPP
@@ -0,0 +1,235 @@
+#ifndef SHAREDCPP_INCLUDE_FBUF_HPP
+#define SHAREDCPP_INCLUDE_FBUF_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace shr
+{
+  // Largest frame over WiFi AX (MSDU limit) and over jumbo Ethernet
+  constexpr size_t MSDU_FRAME_SIZE = 2304;
+  constexpr size_t JUMBO_FRAME_SIZE = 9000;
+
+  class FramePool;
+
+  /**
+   * Bookkeeping in front of every pooled frame's bytes
+   */
+  struct FrameHeader
+  {
+    std::atomic<uint32_t> refs{0};
+    std::atomic<uint32_t> next{0}; // free list link: index + 1, 0 = end
+    uint32_t index = 0;
+    uint32_t length = 0; // bytes in use
+    FramePool *pool = nullptr;
+  };
+
+  /**
+   * Refcounted handle to a pooled frame. Copies share the frame (one atomic
+   * increment, no byte copy); the frame goes back to its pool when the last
+   * handle is dropped. Handles may be passed between threads, but the bytes
+   * are not synchronised: fill the frame first, then share it read-only.
+   */
+  class FrameRef
+  {
+  public:
+    FrameRef() = default;
+    FrameRef(const FrameRef &other) : frame_(other.frame_)
+    {
+      if (frame_)
+        frame_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    FrameRef(FrameRef &&other) noexcept : frame_(std::exchange(other.frame_, nullptr)) {}
+
+    FrameRef &operator=(const FrameRef &other)
+    {
+      if (this != &other)
+      {
+        FrameRef copy(other);
+        std::swap(frame_, copy.frame_);
+      }
+      return *this;
+    }
+
+    FrameRef &operator=(FrameRef &&other) noexcept
+    {
+      if (this != &other)
+      {
+        reset();
+        frame_ = std::exchange(other.frame_, nullptr);
+      }
+      return *this;
+    }
+
+    ~FrameRef() { reset(); }
+
+    /**
+     * Drop this handle's reference
+     */
+    inline void reset();
+
+    inline explicit operator bool() const { return frame_ != nullptr; }
+
+    inline uint8_t *data() const { return reinterpret_cast<uint8_t *>(frame_) + DATA_OFFSET; }
+    inline size_t size() const { return frame_->length; }
+    inline size_t capacity() const;
+
+    /**
+     * Set the number of bytes in use, e.g. after recv() into data()
+     * @param length at most capacity()
+     */
+    inline void resize(size_t length) { frame_->length = static_cast<uint32_t>(length); }
+
+    inline std::span<uint8_t> bytes() const { return {data(), size()}; }
+
+    /**
+     * @return number of handles sharing the frame (racy, for tests and stats)
+     */
+    inline uint32_t useCount() const { return frame_ ? frame_->refs.load(std::memory_order_relaxed) : 0; }
+
+    // Frame bytes start one cache line after the header
+    static constexpr size_t DATA_OFFSET = 64;
+    static_assert(sizeof(FrameHeader) <= DATA_OFFSET);
+
+  private:
+    friend class FramePool;
+    explicit FrameRef(FrameHeader *frame) : frame_(frame) {}
+
+    FrameHeader *frame_ = nullptr;
+  };
+
+  /**
+   * Fixed set of equal-capacity frames carved out of one allocation at
+   * construction. acquire() and release are lock-free (a Treiber stack of
+   * frame indices with an ABA tag) and never call malloc, so receive,
+   * verify and fan-out can pass one frame along without copying it.
+   *
+   * Frames are cache-line aligned and padded so neighbouring frames never
+   * share a line. Every handle must be dropped before the pool is destroyed.
+   */
+  class FramePool
+  {
+  public:
+    /**
+     * @param frame_capacity bytes per frame, e.g. MSDU_FRAME_SIZE
+     * @param count number of frames
+     */
+    FramePool(size_t frame_capacity, size_t count)
+      : capacity_(frame_capacity),
+        stride_((FrameRef::DATA_OFFSET + frame_capacity + ALIGN - 1) / ALIGN * ALIGN),
+        count_(count),
+        storage_(static_cast<std::byte *>(::operator new(stride_ * count, std::align_val_t(ALIGN))))
+    {
+      for (size_t i = 0; i < count_; ++i)
+      {
+        FrameHeader *frame = new (storage_ + i * stride_) FrameHeader();
+        frame->index = static_cast<uint32_t>(i);
+        frame->pool = this;
+      }
+      // Push in reverse so frames come out in address order
+      for (size_t i = count_; i > 0; --i)
+        push(header(static_cast<uint32_t>(i - 1)));
+    }
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    ~FramePool()
+    {
+      for (size_t i = 0; i < count_; ++i)
+        header(static_cast<uint32_t>(i))->~FrameHeader();
+      ::operator delete(storage_, std::align_val_t(ALIGN));
+    }
+
+    /**
+     * @return a handle to an empty frame, or an empty handle if every frame
+     *         is in use (the caller drops the packet; the pool never grows)
+     */
+    FrameRef acquire()
+    {
+      FrameHeader *frame = pop();
+      if (!frame)
+        return FrameRef();
+      frame->length = 0;
+      frame->refs.store(1, std::memory_order_relaxed);
+      return FrameRef(frame);
+    }
+
+    inline size_t frameCapacity() const { return capacity_; }
+    inline size_t count() const { return count_; }
+
+    /**
+     * @return frames not in use (approximate while other threads run)
+     */
+    inline size_t available() const { return available_.load(std::memory_order_relaxed); }
+
+  private:
+    friend class FrameRef;
+
+    static constexpr size_t ALIGN = 64;
+
+    inline FrameHeader *header(uint32_t index) const
+    {
+      return reinterpret_cast<FrameHeader *>(storage_ + index * stride_);
+    }
+
+    // head_: low 32 bits index + 1 (0 = empty), high 32 bits a tag bumped on
+    // every change so a pop that raced a pop+push cannot succeed (ABA)
+    void push(FrameHeader *frame)
+    {
+      uint64_t head = head_.load(std::memory_order_relaxed);
+      uint64_t next;
+      do
+      {
+        frame->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (frame->index + 1u);
+      } while (!head_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+      available_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    FrameHeader *pop()
+    {
+      uint64_t head = head_.load(std::memory_order_acquire);
+      FrameHeader *frame;
+      uint64_t next;
+      do
+      {
+        uint32_t top = static_cast<uint32_t>(head);
+        if (top == 0)
+          return nullptr;
+        frame = header(top - 1);
+        next = ((head >> 32) + 1) << 32 | frame->next.load(std::memory_order_relaxed);
+      } while (!head_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire));
+      available_.fetch_sub(1, std::memory_order_relaxed);
+      return frame;
+    }
+
+    size_t capacity_;
+    size_t stride_;
+    size_t count_;
+    std::byte *storage_;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    std::atomic<size_t> available_{0};
+  };
+
+  inline void FrameRef::reset()
+  {
+    if (!frame_)
+      return;
+    // acq_rel: the thread returning the frame sees every other holder's reads
+    if (frame_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      frame_->pool->push(frame_);
+    frame_ = nullptr;
+  }
+
+  inline size_t FrameRef::capacity() const
+  {
+    return frame_->pool->frameCapacity();
+  }
+}
+
+#endif // SHAREDCPP_INCLUDE_FBUF_HPP
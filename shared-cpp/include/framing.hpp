@@ -0,0 +1,254 @@
+#ifndef SHAREDCPP_INCLUDE_FRAMING_HPP
+#define SHAREDCPP_INCLUDE_FRAMING_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include <sys/uio.h>
+
+#include "crypto.hpp"
+#include "msg.hpp"
+
+/**
+ * Variable-length message framing.
+ *
+ * A frame is the same bytes a WireableMessage puts on the wire, but with a
+ * payload of any length (log text, batched telemetry):
+ *
+ *   offset  size  field
+ *   0       1     version (MessageHeader::CURRENT_VERSION)
+ *   1       1     message type
+ *   2       2     payload length, little-endian
+ *   4       1     integrity mode (shr::Integrity)
+ *   5       4     sequence number, little-endian
+ *   9       4     sender timestamp in microseconds, little-endian
+ *   13      n     payload
+ *   13 + n  t     integrity trailer over header and payload, t from the mode
+ *
+ * Multi-byte fields are written byte by byte, so the encoding does not
+ * depend on the host's byte order. The encoder hands header, payload and
+ * trailer back as separate iovecs for sendmsg; the payload is never copied.
+ */
+namespace shr
+{
+  constexpr size_t FRAME_HEADER_SIZE = 13;
+  constexpr size_t FRAME_MAX_TRAILER = 32;
+  constexpr size_t FRAME_MAX_PAYLOAD = UINT16_MAX;
+
+  namespace frame_offset
+  {
+    constexpr size_t VERSION = 0;
+    constexpr size_t MESSAGE_TYPE = 1;
+    constexpr size_t LENGTH = 2;
+    constexpr size_t INTEGRITY = 4;
+    constexpr size_t SEQUENCE = 5;
+    constexpr size_t TIMESTAMP = 9;
+  }
+
+  // The framing layout and the packed MessageHeader must agree, so a
+  // WireableMessage<T> decodes as a frame with a sizeof(T) payload
+  static_assert(sizeof(MessageHeader) == FRAME_HEADER_SIZE);
+  static_assert(offsetof(MessageHeader, version) == frame_offset::VERSION);
+  static_assert(offsetof(MessageHeader, message_type) == frame_offset::MESSAGE_TYPE);
+  static_assert(offsetof(MessageHeader, message_length) == frame_offset::LENGTH);
+  static_assert(offsetof(MessageHeader, integrity) == frame_offset::INTEGRITY);
+  static_assert(offsetof(MessageHeader, sequence) == frame_offset::SEQUENCE);
+  static_assert(offsetof(MessageHeader, timestamp_us) == frame_offset::TIMESTAMP);
+  static_assert(integrityTagSize(Integrity::SHA256) <= FRAME_MAX_TRAILER);
+  // WireableMessage stores its multi-byte fields in host order; every target
+  // (x86, ARM, ESP32) is little-endian, which is what frames use
+  static_assert(std::endian::native == std::endian::little);
+
+  inline void storeLe16(uint8_t* p, uint16_t v)
+  {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+  }
+
+  inline uint16_t loadLe16(const uint8_t* p)
+  {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  inline void storeLe32(uint8_t* p, uint32_t v)
+  {
+    for (int i = 0; i < 4; ++i)
+      p[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+
+  inline uint32_t loadLe32(const uint8_t* p)
+  {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  inline bool isKnownIntegrity(uint8_t mode)
+  {
+    return mode <= static_cast<uint8_t>(Integrity::SHA256);
+  }
+
+  /**
+   * Compute the integrity trailer over the concatenation of iov
+   * @param mode integrity mode
+   * @param out integrityTagSize(mode) bytes are written
+   * @return false if the mode needs a key and none is set
+   */
+  inline bool computeTag(Integrity mode, const struct iovec* iov, int iovcnt, uint8_t out[FRAME_MAX_TRAILER])
+  {
+    switch (mode)
+    {
+    case Integrity::NONE:
+      return true;
+    case Integrity::CRC32C:
+    {
+      uint32_t crc = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        crc = crypto::crc32c(static_cast<const uint8_t*>(iov[i].iov_base), iov[i].iov_len, crc);
+      storeLe32(out, crc);
+      return true;
+    }
+    case Integrity::HMAC_SHA256_128:
+      if (!integrityKey().isSet())
+        return false;
+      integrityKey().mac(iov, iovcnt, out);
+      return true;
+    case Integrity::SHA256:
+      crypto::sha256_hash(iov, iovcnt, out);
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Builds frames around caller-owned payloads. Holds the header and
+   * trailer bytes, so one encoder serves one frame at a time; the payload
+   * must stay alive until the iovecs are sent.
+   */
+  class FrameEncoder
+  {
+  public:
+    /**
+     * @param message_type MessageHeader::MSG_TYPE_*
+     * @param mode integrity mode, see defaultIntegrity()
+     * @param payload payload bytes
+     * @param len payload length, at most FRAME_MAX_PAYLOAD
+     * @param sequence next sequence number on the link
+     * @param timestamp_us sender's monotonic clock in microseconds
+     * @return header, payload and trailer iovecs (trailer omitted for
+     *         Integrity::NONE); empty if len is too long or the mode needs a
+     *         key that is not set
+     */
+    std::span<const struct iovec> encode(uint8_t message_type, Integrity mode, const uint8_t* payload, size_t len,
+                                         uint32_t sequence = 0, uint32_t timestamp_us = 0)
+    {
+      if (len > FRAME_MAX_PAYLOAD)
+        return {};
+
+      header_[frame_offset::VERSION] = MessageHeader::CURRENT_VERSION;
+      header_[frame_offset::MESSAGE_TYPE] = message_type;
+      storeLe16(header_ + frame_offset::LENGTH, static_cast<uint16_t>(len));
+      header_[frame_offset::INTEGRITY] = static_cast<uint8_t>(mode);
+      storeLe32(header_ + frame_offset::SEQUENCE, sequence);
+      storeLe32(header_ + frame_offset::TIMESTAMP, timestamp_us);
+
+      iov_[0] = {header_, FRAME_HEADER_SIZE};
+      iov_[1] = {const_cast<uint8_t*>(payload), len};
+      if (!computeTag(mode, iov_, 2, trailer_))
+        return {};
+
+      size_t tag = integrityTagSize(mode);
+      if (tag == 0)
+        return {iov_, 2};
+      iov_[2] = {trailer_, tag};
+      return {iov_, 3};
+    }
+
+    /**
+     * @return bytes on the wire for a payload of len bytes
+     */
+    static constexpr size_t frameSize(size_t len, Integrity mode)
+    {
+      return FRAME_HEADER_SIZE + len + integrityTagSize(mode);
+    }
+
+  private:
+    uint8_t header_[FRAME_HEADER_SIZE];
+    uint8_t trailer_[FRAME_MAX_TRAILER];
+    struct iovec iov_[3];
+  };
+
+  enum class FrameError : uint8_t
+  {
+    NONE = 0,
+    TRUNCATED,  // buffer shorter than the header or the declared frame
+    VERSION,    // unsupported protocol version
+    INTEGRITY,  // unknown mode, missing key or trailer mismatch
+  };
+
+  /**
+   * A decoded frame; points into the receive buffer
+   */
+  struct FrameView
+  {
+    uint8_t message_type = MessageHeader::MSG_TYPE_UNDEFINED;
+    Integrity integrity = Integrity::NONE;
+    uint32_t sequence = 0;
+    uint32_t timestamp_us = 0;
+    const uint8_t* payload = nullptr;
+    size_t payload_length = 0;
+    size_t frame_length = 0; // header + payload + trailer; the next frame starts here
+  };
+
+  /**
+   * Parse and verify the frame at the start of data. Bytes past the frame
+   * are left alone, so several frames can be read from one datagram.
+   *
+   * The integrity mode comes from the frame itself; receivers should check
+   * view.integrity against what they require for view.message_type (e.g.
+   * defaultIntegrity()) before acting on it.
+   * @param data received bytes
+   * @param len number of bytes
+   * @param view filled in on success
+   * @return FrameError::NONE on success
+   */
+  inline FrameError decodeFrame(const uint8_t* data, size_t len, FrameView& view)
+  {
+    if (len < FRAME_HEADER_SIZE)
+      return FrameError::TRUNCATED;
+    if (data[frame_offset::VERSION] != MessageHeader::CURRENT_VERSION)
+      return FrameError::VERSION;
+    uint8_t mode = data[frame_offset::INTEGRITY];
+    if (!isKnownIntegrity(mode))
+      return FrameError::INTEGRITY;
+
+    Integrity integrity = static_cast<Integrity>(mode);
+    size_t payload_length = loadLe16(data + frame_offset::LENGTH);
+    size_t tag = integrityTagSize(integrity);
+    size_t frame_length = FRAME_HEADER_SIZE + payload_length + tag;
+    if (len < frame_length)
+      return FrameError::TRUNCATED;
+
+    if (integrity != Integrity::NONE)
+    {
+      struct iovec iov = {const_cast<uint8_t*>(data), FRAME_HEADER_SIZE + payload_length};
+      uint8_t expected[FRAME_MAX_TRAILER];
+      if (!computeTag(integrity, &iov, 1, expected) ||
+          !crypto::ct_equal(expected, data + FRAME_HEADER_SIZE + payload_length, tag))
+        return FrameError::INTEGRITY;
+    }
+
+    view.message_type = data[frame_offset::MESSAGE_TYPE];
+    view.integrity = integrity;
+    view.sequence = loadLe32(data + frame_offset::SEQUENCE);
+    view.timestamp_us = loadLe32(data + frame_offset::TIMESTAMP);
+    view.payload = data + FRAME_HEADER_SIZE;
+    view.payload_length = payload_length;
+    view.frame_length = frame_length;
+    return FrameError::NONE;
+  }
+}
+
+#endif // SHAREDCPP_INCLUDE_FRAMING_HPP
@@ -0,0 +1,272 @@
+#ifndef SHAREDCPP_INCLUDE_LINK_HPP
+#define SHAREDCPP_INCLUDE_LINK_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "msg.hpp"
+
+/**
+ * Receive-side state of one robot link peer: a sliding replay window over
+ * the header sequence numbers, staleness from the sender timestamps, and
+ * loss/reorder/jitter counters.
+ *
+ * Sequence numbers count datagrams (a bundle has one), start anywhere and
+ * wrap; they are widened to 64 bits internally. A peer that restarts begins
+ * again behind the window, so RESYNC_RUN consecutive sequence numbers whose
+ * timestamps do not go backwards, all TOO_OLD with nothing admitted in
+ * between, restart the window from the last of them; replayed old traffic
+ * can only do that while the real peer is silent. Sender and receiver clocks
+ * are not synchronised: staleness is judged on the one-way transit time
+ * relative to the fastest transit of the last TRANSIT_WINDOW_US, so clock
+ * drift and an odd early sample age out instead of piling up.
+ */
+namespace shr
+{
+  enum class Admission : uint8_t
+  {
+    NEW = 0,   // newest datagram so far
+    REORDERED, // older than the newest, inside the window and not seen before
+    DUPLICATE, // already received
+    TOO_OLD,   // behind the window
+    STALE,     // sequence fine, but in flight longer than the allowed age
+  };
+
+  /**
+   * Counters since the link started, for monitoring
+   */
+  struct LinkStats
+  {
+    uint64_t received = 0;   // distinct datagrams admitted or stale
+    uint64_t lost = 0;       // sequence numbers never received (may shrink as late ones arrive)
+    uint64_t reordered = 0;  // admitted out of order
+    uint64_t duplicates = 0;
+    uint64_t too_old = 0;
+    uint64_t stale = 0;
+    uint64_t resyncs = 0;    // peer restarts detected
+    double jitter_us = 0.0;  // RFC 3550 interarrival jitter
+  };
+
+  /**
+   * @return true if the payloads of a datagram with this admission may be
+   *         acted on for message_type. Commands and e-stops are
+   *         latest-wins: a reordered one is older than what the robot
+   *         already obeys, so it is dropped too.
+   */
+  constexpr bool admits(Admission admission, uint8_t message_type)
+  {
+    switch (admission)
+    {
+    case Admission::NEW:
+      return true;
+    case Admission::REORDERED:
+      return message_type != MessageHeader::MSG_TYPE_COMMAND && message_type != MessageHeader::MSG_TYPE_ESTOP;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * One per peer. admit() is called from the receive thread only; stats()
+   * may be called from any thread.
+   */
+  class LinkReceiver
+  {
+  public:
+    static constexpr uint32_t WINDOW = 64; // sequence numbers tracked behind the newest
+    static constexpr uint64_t TRANSIT_WINDOW_US = 10000000; // minimum transit is taken over 10-20 s
+    static constexpr uint32_t RESYNC_RUN = 8; // TOO_OLD datagrams in a row that mean the peer restarted
+
+    /**
+     * @param max_age_us datagrams whose transit exceeds the recent fastest
+     *        by more than this are STALE; 0 disables the check
+     */
+    explicit LinkReceiver(uint32_t max_age_us = 0) : max_age_us_(max_age_us) {}
+
+    /**
+     * Account for a verified datagram
+     * @param sequence header sequence number
+     * @param timestamp_us header sender timestamp
+     * @param now_us receiver's monotonic clock
+     * @return what to do with it, see admits()
+     */
+    Admission admit(uint32_t sequence, uint32_t timestamp_us, uint64_t now_us)
+    {
+      if (!started_)
+      {
+        start(sequence);
+        return accept(Admission::NEW, timestamp_us, now_us);
+      }
+
+      // Widen: nearest 64-bit value to the newest with these low 32 bits
+      uint64_t seq = highest_ + static_cast<int64_t>(static_cast<int32_t>(sequence - static_cast<uint32_t>(highest_)));
+      if (seq > highest_)
+      {
+        uint64_t shift = seq - highest_;
+        window_ = shift >= WINDOW ? 1 : (window_ << shift) | 1;
+        highest_ = seq;
+        return accept(Admission::NEW, timestamp_us, now_us);
+      }
+
+      uint64_t back = highest_ - seq;
+      if (back >= WINDOW || seq < first_)
+        return tooOld(sequence, seq, timestamp_us, now_us);
+      uint64_t bit = uint64_t(1) << back;
+      if (window_ & bit)
+      {
+        bump(duplicates_);
+        return Admission::DUPLICATE;
+      }
+      window_ |= bit;
+      bump(reordered_);
+      return accept(Admission::REORDERED, timestamp_us, now_us);
+    }
+
+    /**
+     * Snapshot of the counters
+     * @return counters since the first datagram
+     */
+    LinkStats stats() const
+    {
+      LinkStats stats;
+      stats.received = received_.load(std::memory_order_relaxed);
+      uint64_t expected = expected_.load(std::memory_order_relaxed);
+      stats.lost = expected > stats.received ? expected - stats.received : 0;
+      stats.reordered = reordered_.load(std::memory_order_relaxed);
+      stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+      stats.too_old = too_old_.load(std::memory_order_relaxed);
+      stats.stale = stale_.load(std::memory_order_relaxed);
+      stats.resyncs = resyncs_.load(std::memory_order_relaxed);
+      stats.jitter_us = static_cast<double>(jitter_x16_.load(std::memory_order_relaxed)) / 16.0;
+      return stats;
+    }
+
+  private:
+    // Single writer: a plain load and store is enough
+    static inline void bump(std::atomic<uint64_t> &counter)
+    {
+      counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void start(uint32_t sequence)
+    {
+      started_ = true;
+      // Offset by 2^32 so widening below the first sequence cannot underflow
+      first_ = static_cast<uint64_t>(sequence) + (uint64_t(1) << 32);
+      highest_ = first_;
+      window_ = 1;
+      run_length_ = 0;
+    }
+
+    Admission accept(Admission admission, uint32_t timestamp_us, uint64_t now_us)
+    {
+      run_length_ = 0;
+      bump(received_);
+      updateTransit(timestamp_us, now_us);
+      expected_.store(expected_base_ + highest_ - first_ + 1, std::memory_order_relaxed);
+      return checkAge(admission);
+    }
+
+    /**
+     * Count a datagram behind the window, or restart the window from it when
+     * it ends a run of RESYNC_RUN: the peer has restarted its sequence numbers
+     */
+    Admission tooOld(uint32_t sequence, uint64_t seq, uint32_t timestamp_us, uint64_t now_us)
+    {
+      if (run_length_ != 0 && seq == run_next_ && static_cast<int32_t>(timestamp_us - run_timestamp_us_) >= 0)
+        ++run_length_;
+      else
+        run_length_ = 1;
+      run_next_ = seq + 1;
+      run_timestamp_us_ = timestamp_us;
+      if (run_length_ < RESYNC_RUN)
+      {
+        bump(too_old_);
+        return Admission::TOO_OLD;
+      }
+
+      // New sender clock too, so the transit reference starts over
+      bump(resyncs_);
+      expected_base_ += highest_ - first_ + 1;
+      have_transit_ = false;
+      start(sequence);
+      return accept(Admission::NEW, timestamp_us, now_us);
+    }
+
+    void updateTransit(uint32_t timestamp_us, uint64_t now_us)
+    {
+      // Offset between the clocks plus the one-way delay. Only differences
+      // matter, and those are taken modulo 2^32 so the offset may be anything.
+      uint32_t transit = static_cast<uint32_t>(now_us) - timestamp_us;
+      if (!have_transit_)
+      {
+        have_transit_ = true;
+        min_transit_ = transit;
+        prev_min_transit_ = transit;
+        bucket_start_us_ = now_us;
+      }
+      else
+      {
+        // RFC 3550 6.4.1, in 1/16 us fixed point: J += (|D| - J) / 16
+        int64_t d = static_cast<int32_t>(transit - last_transit_);
+        uint64_t abs_d = static_cast<uint64_t>(d < 0 ? -d : d);
+        uint64_t jitter = jitter_x16_.load(std::memory_order_relaxed);
+        jitter = jitter + abs_d - (jitter + 8) / 16;
+        jitter_x16_.store(jitter, std::memory_order_relaxed);
+
+        // Two-bucket windowed minimum: the reference covers between one and
+        // two windows of history
+        if (now_us - bucket_start_us_ >= TRANSIT_WINDOW_US)
+        {
+          prev_min_transit_ = min_transit_;
+          min_transit_ = transit;
+          bucket_start_us_ = now_us;
+        }
+        else if (static_cast<int32_t>(transit - min_transit_) < 0)
+        {
+          min_transit_ = transit;
+        }
+      }
+      last_transit_ = transit;
+    }
+
+    Admission checkAge(Admission admission)
+    {
+      uint32_t fastest = static_cast<int32_t>(prev_min_transit_ - min_transit_) < 0 ? prev_min_transit_ : min_transit_;
+      if (max_age_us_ != 0 && static_cast<int64_t>(static_cast<int32_t>(last_transit_ - fastest)) > static_cast<int64_t>(max_age_us_))
+      {
+        bump(stale_);
+        return Admission::STALE;
+      }
+      return admission;
+    }
+
+    uint32_t max_age_us_;
+
+    // Receive thread only
+    bool started_ = false;
+    uint64_t first_ = 0;   // widened sequence of the first datagram
+    uint64_t highest_ = 0; // widened sequence of the newest datagram
+    uint64_t window_ = 0;  // bit i: highest_ - i received
+    uint64_t expected_base_ = 0; // expected datagrams before the last resync
+    uint32_t run_length_ = 0;    // consecutive TOO_OLD datagrams, see tooOld()
+    uint64_t run_next_ = 0;      // widened sequence that continues the run
+    uint32_t run_timestamp_us_ = 0;
+    bool have_transit_ = false;
+    uint32_t min_transit_ = 0;      // fastest in the current window
+    uint32_t prev_min_transit_ = 0; // fastest in the previous window
+    uint64_t bucket_start_us_ = 0;
+    uint32_t last_transit_ = 0;
+
+    std::atomic<uint64_t> expected_{0}; // highest_ - first_ + 1
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> reordered_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> too_old_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> resyncs_{0};
+    std::atomic<uint64_t> jitter_x16_{0};
+  };
+}
+
+#endif // SHAREDCPP_INCLUDE_LINK_HPP
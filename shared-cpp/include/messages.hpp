@@ -0,0 +1,27 @@
+#ifndef SHAREDCPP_INCLUDE_MESSAGES_HPP
+#define SHAREDCPP_INCLUDE_MESSAGES_HPP
+
+#include <cstdint>
+
+#include "msg.hpp"
+#include "protocol.hpp"
+#include "registry.hpp"
+
+/**
+ * The registry tying the robot link message types to their payloads. The
+ * fixed-size payload structs are generated from shared-cpp/schema/protocol.json
+ * into protocol.hpp; they are packed and little-endian (framing.hpp asserts
+ * the host is). Id 5 is unassigned.
+ */
+namespace shr
+{
+  using LogMessage = MessageType<MessageHeader::MSG_TYPE_LOG, RawPayload>;
+  using HeartbeatMessage = MessageType<MessageHeader::MSG_TYPE_HEARTBEAT, HeartbeatPayload>;
+  using CommandMessage = MessageType<MessageHeader::MSG_TYPE_COMMAND, DriveCommandPayload>;
+  using StatusMessage = MessageType<MessageHeader::MSG_TYPE_STATUS, RawPayload>; // keyframe/delta telemetry, see status.hpp
+  using EstopMessage = MessageType<MessageHeader::MSG_TYPE_ESTOP, EstopPayload>;
+
+  using RobotMessages = MessageRegistry<LogMessage, HeartbeatMessage, CommandMessage, StatusMessage, EstopMessage>;
+}
+
+#endif // SHAREDCPP_INCLUDE_MESSAGES_HPP
@@ -1,55 +1,199 @@
 #ifndef SHAREDCPP_INCLUDE_MSG_HPP
 #define SHAREDCPP_INCLUDE_MSG_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 #include "crypto.hpp"
 
 namespace shr
 {
+  /**
+   * How a message's trailer protects the header and payload
+   */
+  enum class Integrity : uint8_t
+  {
+    NONE = 0,            // no trailer; loopback only
+    CRC32C = 1,          // 4-byte checksum: catches corruption, not forgery
+    HMAC_SHA256_128 = 2, // HMAC-SHA256 truncated to 16 bytes, needs setIntegrityKey()
+    SHA256 = 3,          // unkeyed 32-byte digest (the version 1 trailer)
+  };
+
+  /**
+   * @return trailer size in bytes
+   */
+  constexpr size_t integrityTagSize(Integrity mode)
+  {
+    switch (mode)
+    {
+    case Integrity::NONE:
+      return 0;
+    case Integrity::CRC32C:
+      return 4;
+    case Integrity::HMAC_SHA256_128:
+      return 16;
+    case Integrity::SHA256:
+      return 32;
+    }
+    return 0;
+  }
+
   struct __attribute__((packed)) MessageHeader
   {
   public:
-    static constexpr uint8_t CURRENT_VERSION = 1;
+    static constexpr uint8_t CURRENT_VERSION = 3; // 2: integrity byte, 3: sequence and timestamp
     static constexpr uint8_t MSG_TYPE_UNDEFINED = 0;
     static constexpr uint8_t MSG_TYPE_LOG = 1;
     static constexpr uint8_t MSG_TYPE_HEARTBEAT = 2;
     static constexpr uint8_t MSG_TYPE_COMMAND = 3;
     static constexpr uint8_t MSG_TYPE_STATUS = 4;
     static constexpr uint8_t MSG_TYPE_ESTOP = 6;
+    static constexpr uint8_t MSG_TYPE_BUNDLE = 7; // several messages in one datagram, see bundle.hpp
 
     uint8_t version = CURRENT_VERSION; // Protocol version
     uint8_t message_type = MSG_TYPE_UNDEFINED;
     uint16_t message_length;
+    uint8_t integrity = static_cast<uint8_t>(Integrity::NONE); // Integrity of the trailer
+    uint32_t sequence = 0;     // per-link counter, see link.hpp
+    uint32_t timestamp_us = 0; // sender's monotonic clock, wraps every ~71 minutes
   };
 
-  template <typename T>
+  /**
+   * Integrity mode each message type is sent with over the network:
+   * anything that moves the robot is authenticated, telemetry only
+   * checksummed. Use Integrity::NONE explicitly for loopback.
+   */
+  constexpr Integrity defaultIntegrity(uint8_t message_type)
+  {
+    switch (message_type)
+    {
+    case MessageHeader::MSG_TYPE_COMMAND:
+    case MessageHeader::MSG_TYPE_ESTOP:
+      return Integrity::HMAC_SHA256_128;
+    default:
+      return Integrity::CRC32C;
+    }
+  }
+
+  /**
+   * Key for Integrity::HMAC_SHA256_128, shared by sender and receiver. Set
+   * it once at startup, before any message is sealed or verified.
+   */
+  inline crypto::HmacSha256Key &integrityKey()
+  {
+    static crypto::HmacSha256Key key;
+    return key;
+  }
+
+  inline void setIntegrityKey(const uint8_t* key, size_t len)
+  {
+    integrityKey().set(key, len);
+  }
+
+  // Trailer bytes; empty for Integrity::NONE
+  template <Integrity MODE>
+  struct __attribute__((packed)) IntegrityTag
+  {
+    uint8_t bytes[integrityTagSize(MODE)];
+  };
+
+  template <>
+  struct IntegrityTag<Integrity::NONE>
+  {
+  };
+
+  template <typename T, Integrity MODE = Integrity::SHA256>
   struct __attribute__((packed)) WireableMessage
   {
   public:
-    constexpr int message_len = sizeof(WireableMessage<T>) - sizeof(sha256);
+    static constexpr Integrity INTEGRITY = MODE;
+    // Bytes covered by the trailer: header and payload (packed, no padding)
+    static constexpr int message_len = sizeof(MessageHeader) + sizeof(T);
     MessageHeader header;
     T payload;
-    char sha256[32]; // SHA-256 of the payload (binary, not hex)
+    [[no_unique_address]] IntegrityTag<MODE> tag;
 
-    inline void hash()
+    /**
+     * Fill in the trailer over the header and payload
+     * @return false if the mode is HMAC and no key is set; the trailer is
+     *         zeroed and the message must not be sent
+     */
+    inline bool seal()
     {
-      uint8_t* payload = reinterpret_cast<uint8_t*>(this);
-      crypto::sha256_hash(payload, message_len, sha256);
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(this);
+      if constexpr (MODE == Integrity::CRC32C)
+      {
+        uint32_t crc = crypto::crc32c(bytes, message_len);
+        for (int i = 0; i < 4; ++i)
+          tag.bytes[i] = static_cast<uint8_t>(crc >> (8 * i)); // little-endian
+      }
+      else if constexpr (MODE == Integrity::HMAC_SHA256_128)
+      {
+        uint8_t mac[32] = {};
+        bool keyed = integrityKey().isSet();
+        if (keyed)
+          integrityKey().mac(bytes, message_len, mac);
+        for (size_t i = 0; i < sizeof(tag.bytes); ++i)
+          tag.bytes[i] = mac[i];
+        return keyed;
+      }
+      else if constexpr (MODE == Integrity::SHA256)
+      {
+        crypto::sha256_hash(bytes, message_len, tag.bytes);
+      }
+      return true;
     }
 
+    /**
+     * @return true if the trailer matches the header and payload. Always
+     *         false for HMAC without a key.
+     */
     inline bool verify() const
     {
-      uint8_t* payload = reinterpret_cast<uint8_t*>(this);
-      return crypto::sha256_verify(payload, message_len, sha256);
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(this);
+      if constexpr (MODE == Integrity::CRC32C)
+      {
+        uint32_t crc = crypto::crc32c(bytes, message_len);
+        uint8_t expected[4];
+        for (int i = 0; i < 4; ++i)
+          expected[i] = static_cast<uint8_t>(crc >> (8 * i));
+        return crypto::ct_equal(expected, tag.bytes, sizeof(expected));
+      }
+      else if constexpr (MODE == Integrity::HMAC_SHA256_128)
+      {
+        if (!integrityKey().isSet())
+          return false;
+        uint8_t mac[32];
+        integrityKey().mac(bytes, message_len, mac);
+        return crypto::ct_equal(mac, tag.bytes, sizeof(tag.bytes));
+      }
+      else if constexpr (MODE == Integrity::SHA256)
+      {
+        return crypto::sha256_verify(bytes, message_len, tag.bytes);
+      }
+      else
+      {
+        return true;
+      }
     }
 
-    inline void prepare(uint8_t msg_type, uint16_t len)
+    /**
+     * Fill in the header and seal
+     * @param msg_type MessageHeader::MSG_TYPE_*
+     * @param len payload length, sizeof(T)
+     * @param sequence next sequence number on the link
+     * @param timestamp_us sender's monotonic clock in microseconds
+     * @return false if the message could not be sealed, see seal()
+     */
+    inline bool prepare(uint8_t msg_type, uint16_t len, uint32_t sequence = 0, uint32_t timestamp_us = 0)
     {
       header.version = MessageHeader::CURRENT_VERSION;
       header.message_type = msg_type;
       header.message_length = len;
-      hash();
+      header.integrity = static_cast<uint8_t>(MODE);
+      header.sequence = sequence;
+      header.timestamp_us = timestamp_us;
+      return seal();
     }
 
     inline bool isValid() const
@@ -57,9 +201,45 @@ namespace shr
       return header.version == MessageHeader::CURRENT_VERSION &&
              header.message_type != MessageHeader::MSG_TYPE_UNDEFINED &&
              header.message_length == sizeof(T) &&
+             header.integrity == static_cast<uint8_t>(MODE) &&
              verify();
     }
   };
+
+  /**
+   * verify() for a whole receive batch. SHA-256 trailers are hashed side by
+   * side in SIMD lanes instead of one after another; the other modes are
+   * checked one by one.
+   * @param msgs received messages
+   * @param count number of messages, at most 64
+   * @return bit i set if msgs[i]->verify() would return true
+   */
+  template <typename T, Integrity MODE>
+  inline uint64_t verifyBatch(const WireableMessage<T, MODE>* const* msgs, int count)
+  {
+    int n = count < 64 ? count : 64;
+    if constexpr (MODE == Integrity::SHA256)
+    {
+      crypto::Sha256VerifyJob jobs[64];
+      for (int i = 0; i < n; ++i)
+      {
+        jobs[i].data = reinterpret_cast<const uint8_t*>(msgs[i]);
+        jobs[i].len = WireableMessage<T, MODE>::message_len;
+        jobs[i].expected = msgs[i]->tag.bytes;
+      }
+      return crypto::sha256_verify_batch(jobs, n);
+    }
+    else
+    {
+      uint64_t valid = 0;
+      for (int i = 0; i < n; ++i)
+      {
+        if (msgs[i]->verify())
+          valid |= uint64_t(1) << i;
+      }
+      return valid;
+    }
+  }
 }
 
 #endif // SHAREDCPP_INCLUDE_MSG_HPP
@@ -0,0 +1,182 @@
+// Generated by shared-cpp/schema/gen_protocol.py from protocol.json. Do not edit.
+
+#ifndef SHAREDCPP_INCLUDE_PROTOCOL_HPP
+#define SHAREDCPP_INCLUDE_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "msg.hpp"
+
+/**
+ * Payload structs of the fixed-size message types (packed,
+ * little-endian), the STATUS telemetry fields, and checks that the
+ * hand-written msg.hpp matches the schema. Edit
+ * shared-cpp/schema/protocol.json and rerun the generator.
+ */
+namespace shr
+{
+  struct __attribute__((packed)) HeartbeatPayload
+  {
+    uint32_t sequence; // incremented per heartbeat by the sender
+    uint32_t uptime_ms; // sender's uptime
+  };
+
+  struct __attribute__((packed)) DriveCommandPayload
+  {
+    int16_t left_mm_s; // left wheel speed
+    int16_t right_mm_s; // right wheel speed
+  };
+
+  struct __attribute__((packed)) EstopPayload
+  {
+    uint8_t engaged; // 1 = stop now, 0 = release
+    uint8_t reason; // sender-defined
+  };
+
+  // MSG_TYPE_STATUS telemetry, see status.hpp. RobotStatus is flattened
+  // depth-first into integer fields, sent as a keyframe (every field as a
+  // varint) or a delta (field mask, then zigzag varint differences from the
+  // keyframe)
+  constexpr uint16_t MOTOR_FLAG_STST = 1 << 0;
+  constexpr uint16_t MOTOR_FLAG_OLB = 1 << 1;
+  constexpr uint16_t MOTOR_FLAG_OLA = 1 << 2;
+  constexpr uint16_t MOTOR_FLAG_S2GB = 1 << 3;
+  constexpr uint16_t MOTOR_FLAG_S2GA = 1 << 4;
+  constexpr uint16_t MOTOR_FLAG_OTPW = 1 << 5;
+  constexpr uint16_t MOTOR_FLAG_OT = 1 << 6;
+  constexpr uint16_t MOTOR_FLAG_STALLGUARD = 1 << 7;
+  constexpr uint16_t MOTOR_FLAG_STEALTH_ACTIVE = 1 << 8;
+
+  constexpr size_t STATUS_MOTOR_COUNT = 4;
+  constexpr uint8_t STATUS_KEYFRAME = 1;
+  constexpr uint8_t STATUS_DELTA = 2;
+  constexpr size_t STATUS_FIELD_COUNT = 23;
+
+  enum class StatusError : uint8_t
+  {
+    NONE = 0,
+    TRUNCATED, // ends inside the mask or a varint
+    BAD_KIND, // neither keyframe nor delta
+    NO_KEYFRAME, // delta against a keyframe we never received
+    MALFORMED, // varint too long or trailing bytes
+  };
+
+  /**
+   * One tmc5160_driver_status_t, booleans folded into flags
+   */
+  struct MotorStatus
+  {
+    uint16_t flags = 0; // motor_flags bits
+    uint16_t stallguard_result = 0;
+    uint8_t cs_actual = 0;
+    uint8_t error_flags = 0;
+
+    bool operator==(const MotorStatus &) const = default;
+  };
+
+  /**
+   * ina228_measurements_t in fixed point, so small changes are small deltas
+   */
+  struct PowerStatus
+  {
+    int32_t bus_voltage_mv = 0;
+    int32_t shunt_voltage_uv = 0;
+    int32_t current_ma = 0;
+    int32_t power_mw = 0;
+    int32_t die_temperature_cdeg = 0; // hundredths of a degree Celsius
+
+    bool operator==(const PowerStatus &) const = default;
+  };
+
+  struct RobotStatus
+  {
+    uint8_t drivers_active = 0;
+    uint32_t communication_errors = 0;
+    MotorStatus motors[STATUS_MOTOR_COUNT];
+    PowerStatus power;
+
+    bool operator==(const RobotStatus &) const = default;
+  };
+
+  namespace status_detail
+  {
+    using Fields = uint32_t[STATUS_FIELD_COUNT];
+
+    // Every field as its 32-bit pattern; differences wrap, so unsigned
+    // counters and signed readings are handled alike
+    inline void flatten(const RobotStatus &status, Fields &out)
+    {
+      size_t i = 0;
+      out[i++] = static_cast<uint32_t>(status.drivers_active);
+      out[i++] = static_cast<uint32_t>(status.communication_errors);
+      for (const MotorStatus &motor : status.motors)
+      {
+        out[i++] = static_cast<uint32_t>(motor.flags);
+        out[i++] = static_cast<uint32_t>(motor.stallguard_result);
+        out[i++] = static_cast<uint32_t>(motor.cs_actual);
+        out[i++] = static_cast<uint32_t>(motor.error_flags);
+      }
+      out[i++] = static_cast<uint32_t>(status.power.bus_voltage_mv);
+      out[i++] = static_cast<uint32_t>(status.power.shunt_voltage_uv);
+      out[i++] = static_cast<uint32_t>(status.power.current_ma);
+      out[i++] = static_cast<uint32_t>(status.power.power_mw);
+      out[i++] = static_cast<uint32_t>(status.power.die_temperature_cdeg);
+    }
+
+    inline void unflatten(const Fields &in, RobotStatus &status)
+    {
+      size_t i = 0;
+      status.drivers_active = static_cast<uint8_t>(in[i++]);
+      status.communication_errors = static_cast<uint32_t>(in[i++]);
+      for (MotorStatus &motor : status.motors)
+      {
+        motor.flags = static_cast<uint16_t>(in[i++]);
+        motor.stallguard_result = static_cast<uint16_t>(in[i++]);
+        motor.cs_actual = static_cast<uint8_t>(in[i++]);
+        motor.error_flags = static_cast<uint8_t>(in[i++]);
+      }
+      status.power.bus_voltage_mv = static_cast<int32_t>(in[i++]);
+      status.power.shunt_voltage_uv = static_cast<int32_t>(in[i++]);
+      status.power.current_ma = static_cast<int32_t>(in[i++]);
+      status.power.power_mw = static_cast<int32_t>(in[i++]);
+      status.power.die_temperature_cdeg = static_cast<int32_t>(in[i++]);
+    }
+  }
+
+  static_assert(sizeof(MessageHeader) == 13);
+  static_assert(offsetof(MessageHeader, version) == 0);
+  static_assert(offsetof(MessageHeader, message_type) == 1);
+  static_assert(offsetof(MessageHeader, message_length) == 2);
+  static_assert(offsetof(MessageHeader, integrity) == 4);
+  static_assert(offsetof(MessageHeader, sequence) == 5);
+  static_assert(offsetof(MessageHeader, timestamp_us) == 9);
+  static_assert(sizeof(HeartbeatPayload) == 8);
+  static_assert(offsetof(HeartbeatPayload, sequence) == 0);
+  static_assert(offsetof(HeartbeatPayload, uptime_ms) == 4);
+  static_assert(sizeof(DriveCommandPayload) == 4);
+  static_assert(offsetof(DriveCommandPayload, left_mm_s) == 0);
+  static_assert(offsetof(DriveCommandPayload, right_mm_s) == 2);
+  static_assert(sizeof(EstopPayload) == 2);
+  static_assert(offsetof(EstopPayload, engaged) == 0);
+  static_assert(offsetof(EstopPayload, reason) == 1);
+
+  static_assert(MessageHeader::CURRENT_VERSION == 3);
+  static_assert(MessageHeader::MSG_TYPE_UNDEFINED == 0);
+  static_assert(MessageHeader::MSG_TYPE_LOG == 1);
+  static_assert(MessageHeader::MSG_TYPE_HEARTBEAT == 2);
+  static_assert(MessageHeader::MSG_TYPE_COMMAND == 3);
+  static_assert(MessageHeader::MSG_TYPE_STATUS == 4);
+  static_assert(MessageHeader::MSG_TYPE_ESTOP == 6);
+  static_assert(MessageHeader::MSG_TYPE_BUNDLE == 7);
+  static_assert(static_cast<uint8_t>(Integrity::NONE) == 0);
+  static_assert(integrityTagSize(Integrity::NONE) == 0);
+  static_assert(static_cast<uint8_t>(Integrity::CRC32C) == 1);
+  static_assert(integrityTagSize(Integrity::CRC32C) == 4);
+  static_assert(static_cast<uint8_t>(Integrity::HMAC_SHA256_128) == 2);
+  static_assert(integrityTagSize(Integrity::HMAC_SHA256_128) == 16);
+  static_assert(static_cast<uint8_t>(Integrity::SHA256) == 3);
+  static_assert(integrityTagSize(Integrity::SHA256) == 32);
+}
+
+#endif // SHAREDCPP_INCLUDE_PROTOCOL_HPP
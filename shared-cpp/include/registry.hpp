@@ -0,0 +1,154 @@
+#ifndef SHAREDCPP_INCLUDE_REGISTRY_HPP
+#define SHAREDCPP_INCLUDE_REGISTRY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "framing.hpp"
+#include "msg.hpp"
+
+/**
+ * Compile-time registry of message types.
+ *
+ * Each MessageType ties a type id to its payload struct. A MessageRegistry
+ * of them builds, per handler type, a 256-entry table of function pointers
+ * at compile time; dispatch is one indexed indirect call with no search, no
+ * virtual calls and no allocation:
+ *
+ *   struct Handler
+ *   {
+ *     void operator()(HeartbeatMessage, const HeartbeatPayload &hb);
+ *     void operator()(LogMessage, std::span<const uint8_t> text);
+ *     ...
+ *   };
+ *   RobotMessages::dispatch(msg.message_type, msg.payload, msg.length, handler);
+ *
+ * Duplicate ids, reserved ids, non-trivially-copyable payloads and handlers
+ * missing an overload are all compile errors.
+ */
+namespace shr
+{
+  /**
+   * Payload marker for variable-length messages; the handler receives the
+   * bytes as a std::span<const uint8_t>
+   */
+  struct RawPayload
+  {
+  };
+
+  template <uint8_t ID, typename Payload>
+  struct MessageType
+  {
+    static constexpr uint8_t id = ID;
+    using payload_type = Payload;
+    static constexpr bool variable = std::is_same_v<Payload, RawPayload>;
+
+    static_assert(ID != MessageHeader::MSG_TYPE_UNDEFINED, "message type id 0 is reserved");
+    static_assert(ID != MessageHeader::MSG_TYPE_BUNDLE, "bundles are unpacked before dispatch");
+    static_assert(variable || std::is_trivially_copyable_v<Payload>, "payloads are copied off the wire byte for byte");
+    static_assert(variable || sizeof(Payload) <= FRAME_MAX_PAYLOAD, "payload does not fit a frame");
+  };
+
+  enum class DispatchResult : uint8_t
+  {
+    HANDLED = 0,
+    UNKNOWN_TYPE, // id not in the registry
+    BAD_LENGTH,   // fixed-size payload with the wrong number of bytes
+  };
+
+  template <typename... Types>
+  class MessageRegistry
+  {
+    static constexpr bool uniqueIds()
+    {
+      constexpr uint8_t ids[] = {Types::id...};
+      for (size_t i = 0; i < sizeof...(Types); ++i)
+      {
+        for (size_t j = i + 1; j < sizeof...(Types); ++j)
+        {
+          if (ids[i] == ids[j])
+            return false;
+        }
+      }
+      return true;
+    }
+
+    static_assert(sizeof...(Types) > 0);
+    static_assert(uniqueIds(), "duplicate message type id in registry");
+
+  public:
+    /**
+     * @return true if id is registered
+     */
+    static constexpr bool contains(uint8_t id)
+    {
+      return ((Types::id == id) || ...);
+    }
+
+    /**
+     * Decode the payload for message type id and call
+     * handler(MessageType{}, payload)
+     * @param id message type from the header
+     * @param payload payload bytes
+     * @param len payload length
+     * @param handler overload set covering every registered type
+     */
+    template <typename Handler>
+    static inline DispatchResult dispatch(uint8_t id, const uint8_t *payload, size_t len, Handler &handler)
+    {
+      return TABLE<Handler>[id](handler, payload, len);
+    }
+
+  private:
+    template <typename Handler>
+    using Thunk = DispatchResult (*)(Handler &, const uint8_t *, size_t);
+
+    template <typename Handler, typename Type>
+    static DispatchResult invoke(Handler &handler, const uint8_t *payload, size_t len)
+    {
+      using Payload = typename Type::payload_type;
+      if constexpr (Type::variable)
+      {
+        static_assert(std::is_invocable_v<Handler &, Type, std::span<const uint8_t>>,
+                      "handler has no overload for this variable-length message type");
+        handler(Type{}, std::span<const uint8_t>(payload, len));
+      }
+      else
+      {
+        static_assert(std::is_invocable_v<Handler &, Type, const Payload &>,
+                      "handler has no overload for this message type");
+        if (len != sizeof(Payload))
+          return DispatchResult::BAD_LENGTH;
+        // Copy out: the wire bytes carry no alignment guarantee
+        Payload value;
+        std::memcpy(&value, payload, sizeof(Payload));
+        handler(Type{}, static_cast<const Payload &>(value));
+      }
+      return DispatchResult::HANDLED;
+    }
+
+    template <typename Handler>
+    static DispatchResult unknown(Handler &, const uint8_t *, size_t)
+    {
+      return DispatchResult::UNKNOWN_TYPE;
+    }
+
+    template <typename Handler>
+    static constexpr std::array<Thunk<Handler>, 256> makeTable()
+    {
+      std::array<Thunk<Handler>, 256> table{};
+      table.fill(&unknown<Handler>);
+      ((table[Types::id] = &invoke<Handler, Types>), ...);
+      return table;
+    }
+
+    template <typename Handler>
+    static constexpr std::array<Thunk<Handler>, 256> TABLE = makeTable<Handler>();
+  };
+}
+
+#endif // SHAREDCPP_INCLUDE_REGISTRY_HPP
@@ -0,0 +1,220 @@
+#ifndef SHAREDCPP_INCLUDE_STATUS_HPP
+#define SHAREDCPP_INCLUDE_STATUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "protocol.hpp"
+
+/**
+ * Compact encoding of MSG_TYPE_STATUS telemetry.
+ *
+ * The robot status (four TMC5160 driver status blocks and the INA228 power
+ * readings) is flattened into STATUS_FIELD_COUNT integer fields; the
+ * structs, flags and field order are generated into protocol.hpp from
+ * shared-cpp/schema/protocol.json. A keyframe carries all of them; a delta
+ * carries only the fields that differ from the last keyframe, each as a
+ * zigzag varint of the difference:
+ *
+ *   offset  size  field
+ *   0       1     kind: STATUS_KEYFRAME or STATUS_DELTA
+ *   1       1     keyframe id, incremented per keyframe
+ *   2       3     delta only: bit i set if field i is present
+ *   ...           one varint per (present) field, in field order
+ *
+ * Deltas are against the keyframe, not the previous status, so a lost or
+ * reordered delta costs nothing; a lost keyframe costs the deltas until the
+ * next one.
+ */
+namespace shr
+{
+  constexpr size_t STATUS_MASK_BYTES = (STATUS_FIELD_COUNT + 7) / 8;
+  constexpr size_t STATUS_MAX_VARINT = 5; // 32 bits in 7-bit groups
+  // Largest encoding, a keyframe or delta with every field at full width
+  constexpr size_t STATUS_MAX_SIZE = 2 + STATUS_MASK_BYTES + STATUS_FIELD_COUNT * STATUS_MAX_VARINT;
+
+  namespace status_detail
+  {
+    constexpr uint32_t zigzag(uint32_t value)
+    {
+      return (value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(value) >> 31);
+    }
+
+    constexpr uint32_t unzigzag(uint32_t value)
+    {
+      return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    inline uint8_t *putVarint(uint8_t *out, uint32_t value)
+    {
+      while (value >= 0x80)
+      {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+      }
+      *out++ = static_cast<uint8_t>(value);
+      return out;
+    }
+
+    /**
+     * @return position after the varint, nullptr if truncated or too long
+     */
+    inline const uint8_t *getVarint(const uint8_t *in, const uint8_t *end, uint32_t &value, StatusError &error)
+    {
+      value = 0;
+      for (size_t i = 0; i < STATUS_MAX_VARINT; ++i)
+      {
+        if (in == end)
+        {
+          error = StatusError::TRUNCATED;
+          return nullptr;
+        }
+        uint8_t byte = *in++;
+        value |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+          return in;
+      }
+      error = StatusError::MALFORMED;
+      return nullptr;
+    }
+  }
+
+  /**
+   * Sender side. Sends a keyframe every keyframe_interval statuses (and the
+   * first time), deltas in between.
+   */
+  class StatusEncoder
+  {
+  public:
+    explicit StatusEncoder(uint32_t keyframe_interval = 32) : interval_(keyframe_interval) {}
+
+    /**
+     * @param status current status
+     * @param out at least STATUS_MAX_SIZE bytes
+     * @return bytes written, the MSG_TYPE_STATUS payload
+     */
+    size_t encode(const RobotStatus &status, uint8_t *out)
+    {
+      status_detail::Fields fields;
+      status_detail::flatten(status, fields);
+
+      uint8_t *p = out;
+      if (since_key_ == 0)
+      {
+        ++key_id_;
+        *p++ = STATUS_KEYFRAME;
+        *p++ = key_id_;
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; ++i)
+        {
+          p = status_detail::putVarint(p, fields[i]);
+          key_[i] = fields[i];
+        }
+      }
+      else
+      {
+        *p++ = STATUS_DELTA;
+        *p++ = key_id_;
+        uint8_t *mask = p;
+        for (size_t i = 0; i < STATUS_MASK_BYTES; ++i)
+          *p++ = 0;
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; ++i)
+        {
+          if (fields[i] == key_[i])
+            continue;
+          mask[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+          p = status_detail::putVarint(p, status_detail::zigzag(fields[i] - key_[i]));
+        }
+      }
+
+      if (++since_key_ >= interval_)
+        since_key_ = 0;
+      return static_cast<size_t>(p - out);
+    }
+
+    /**
+     * Make the next encode() a keyframe, e.g. when a receiver (re)connects
+     */
+    inline void forceKeyframe() { since_key_ = 0; }
+
+  private:
+    uint32_t interval_;
+    uint32_t since_key_ = 0;
+    uint8_t key_id_ = 0;
+    status_detail::Fields key_ = {};
+  };
+
+  /**
+   * Receiver side
+   */
+  class StatusDecoder
+  {
+  public:
+    /**
+     * @param payload MSG_TYPE_STATUS payload
+     * @param len payload length
+     * @param out decoded status; unchanged on error
+     */
+    StatusError decode(const uint8_t *payload, size_t len, RobotStatus &out)
+    {
+      if (len < 2)
+        return StatusError::TRUNCATED;
+      const uint8_t *end = payload + len;
+      uint8_t kind = payload[0];
+      uint8_t key_id = payload[1];
+      const uint8_t *p = payload + 2;
+      StatusError error = StatusError::NONE;
+      status_detail::Fields fields;
+
+      if (kind == STATUS_KEYFRAME)
+      {
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; ++i)
+        {
+          if (!(p = status_detail::getVarint(p, end, fields[i], error)))
+            return error;
+        }
+      }
+      else if (kind == STATUS_DELTA)
+      {
+        if (!have_key_ || key_id != key_id_)
+          return StatusError::NO_KEYFRAME;
+        if (static_cast<size_t>(end - p) < STATUS_MASK_BYTES)
+          return StatusError::TRUNCATED;
+        const uint8_t *mask = p;
+        p += STATUS_MASK_BYTES;
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; ++i)
+        {
+          fields[i] = key_[i];
+          if (!(mask[i / 8] & (1 << (i % 8))))
+            continue;
+          uint32_t delta;
+          if (!(p = status_detail::getVarint(p, end, delta, error)))
+            return error;
+          fields[i] += status_detail::unzigzag(delta);
+        }
+      }
+      else
+      {
+        return StatusError::BAD_KIND;
+      }
+
+      if (p != end)
+        return StatusError::MALFORMED;
+      if (kind == STATUS_KEYFRAME)
+      {
+        for (size_t i = 0; i < STATUS_FIELD_COUNT; ++i)
+          key_[i] = fields[i];
+        key_id_ = key_id;
+        have_key_ = true;
+      }
+      status_detail::unflatten(fields, out);
+      return StatusError::NONE;
+    }
+
+  private:
+    bool have_key_ = false;
+    uint8_t key_id_ = 0;
+    status_detail::Fields key_ = {};
+  };
+}
+
+#endif // SHAREDCPP_INCLUDE_STATUS_HPP
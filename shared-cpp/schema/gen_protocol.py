@@ -0,0 +1,543 @@
+#!/usr/bin/env python3
+"""
+Generate the robot link wire definitions from protocol.json
+
+Outputs (committed, so the firmware and frontend builds need no Python):
+  shared-cpp/include/protocol.hpp   packed C++ payload structs, checked against msg.hpp,
+                                    and the STATUS structs and field order for status.hpp
+  firmware/main/protocol.h          the same structs in C for the ESP32 firmware
+  frontend/service/protocol.ts      DataView read/write codecs and a STATUS decoder
+                                    for the browser
+
+All three are little-endian and packed; every side asserts the sizes and
+offsets computed here.
+
+Usage:
+  gen_protocol.py           rewrite the outputs
+  gen_protocol.py --check   exit 1 if an output is out of date
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+SCHEMA_DIR = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(SCHEMA_DIR, '..', '..'))
+SCHEMA = os.path.join(SCHEMA_DIR, 'protocol.json')
+
+CPP_OUT = os.path.join(ROOT, 'shared-cpp', 'include', 'protocol.hpp')
+C_OUT = os.path.join(ROOT, 'firmware', 'main', 'protocol.h')
+TS_OUT = os.path.join(ROOT, 'frontend', 'service', 'protocol.ts')
+
+BANNER = 'Generated by shared-cpp/schema/gen_protocol.py from protocol.json. Do not edit.'
+
+# schema type: (size, C/C++ type, DataView suffix)
+TYPES = {
+    'u8': (1, 'uint8_t', 'Uint8'),
+    'i8': (1, 'int8_t', 'Int8'),
+    'u16': (2, 'uint16_t', 'Uint16'),
+    'i16': (2, 'int16_t', 'Int16'),
+    'u32': (4, 'uint32_t', 'Uint32'),
+    'i32': (4, 'int32_t', 'Int32'),
+    'f32': (4, 'float', 'Float32'),
+}
+
+
+def snake(name):
+    return re.sub(r'(?<!^)(?=[A-Z])', '_', name).lower()
+
+
+def load_schema():
+    with open(SCHEMA) as f:
+        schema = json.load(f)
+
+    structs = {}
+    for struct in schema['structs']:
+        offset = 0
+        for field in struct['fields']:
+            if field['type'] not in TYPES:
+                sys.exit(f"{struct['name']}.{field['name']}: unknown type {field['type']}")
+            field['offset'] = offset
+            offset += TYPES[field['type']][0]
+        struct['size'] = offset
+        structs[struct['name']] = struct
+
+    status = schema['status']
+    status['struct_map'] = {}
+    for struct in status['structs']:
+        for field in struct['fields']:
+            if 'struct' in field:
+                if field['struct'] not in status['struct_map']:
+                    sys.exit(f"{struct['name']}.{field['name']}: unknown struct {field['struct']}")
+                count = field.get('count', 1)
+                field['count_value'] = status[count] if isinstance(count, str) else count
+            elif field['type'] not in TYPES or field['type'] == 'f32':
+                sys.exit(f"{struct['name']}.{field['name']}: status fields must be integers")
+        status['struct_map'][struct['name']] = struct
+    status['root'] = status['structs'][-1]
+    status['field_count'] = leaf_count(status, status['root'])
+    if len(status['motor_flags']) > 16:
+        sys.exit('motor_flags do not fit MotorStatus.flags')
+
+    ids = set()
+    for msg in schema['message_types']:
+        if msg['id'] in ids:
+            sys.exit(f"duplicate message type id {msg['id']}")
+        ids.add(msg['id'])
+        if 'payload' in msg and msg['payload'] not in structs:
+            sys.exit(f"{msg['name']}: unknown payload {msg['payload']}")
+    return schema, structs
+
+
+def leaf_count(status, struct):
+    total = 0
+    for field in struct['fields']:
+        if 'struct' in field:
+            total += field['count_value'] * leaf_count(status, status['struct_map'][field['struct']])
+        else:
+            total += 1
+    return total
+
+
+def loop_var(struct_name):
+    return snake(struct_name).split('_')[0]
+
+
+def walk_status(status, struct, expr, indent, leaf, loop):
+    """
+    Lines visiting every leaf field of struct in wire order
+    leaf(expr, type) -> line; loop(var, struct_name, expr) -> opening lines
+    """
+    lines = []
+    for field in struct['fields']:
+        path = expr + field['name']
+        if 'struct' not in field:
+            lines.append(indent + leaf(path, field['type']))
+            continue
+        sub = status['struct_map'][field['struct']]
+        if 'count' in field:
+            var = loop_var(field['struct'])
+            lines += [indent + line for line in loop(var, field['struct'], path)]
+            lines += walk_status(status, sub, var + '.', indent + '  ', leaf, loop)
+            lines.append(indent + '}')
+        else:
+            lines += walk_status(status, sub, path + '.', indent, leaf, loop)
+    return lines
+
+
+def field_comment(field):
+    return f" // {field['comment']}" if 'comment' in field else ''
+
+
+def gen_cpp_status(status):
+    out = ['  // ' + line for line in wrap(status['comment'], 74)]
+    for bit, flag in enumerate(status['motor_flags']):
+        out.append(f"  constexpr uint16_t MOTOR_FLAG_{flag} = 1 << {bit};")
+    out.append('')
+    out.append(f"  constexpr size_t STATUS_MOTOR_COUNT = {status['motor_count']};")
+    for kind in status['kinds']:
+        out.append(f"  constexpr uint8_t STATUS_{kind['name']} = {kind['id']};")
+    out.append(f"  constexpr size_t STATUS_FIELD_COUNT = {status['field_count']};")
+    out += ['', '  enum class StatusError : uint8_t', '  {']
+    for i, error in enumerate(status['errors']):
+        value = ' = 0' if i == 0 else ''
+        out.append(f"    {error['name']}{value},{field_comment(error)}")
+    out += ['  };', '']
+
+    for struct in status['structs']:
+        if 'comment' in struct:
+            out += ['  /**', f"   * {struct['comment']}", '   */']
+        out += [f"  struct {struct['name']}", '  {']
+        for field in struct['fields']:
+            if 'struct' not in field:
+                out.append(f"    {TYPES[field['type']][1]} {field['name']} = 0;{field_comment(field)}")
+            elif 'count' in field:
+                out.append(f"    {field['struct']} {field['name']}[STATUS_{field['count'].upper()}];")
+            else:
+                out.append(f"    {field['struct']} {field['name']};")
+        out += ['', f"    bool operator==(const {struct['name']} &) const = default;", '  };', '']
+
+    root = status['root']['name']
+    loop = lambda var, name, expr: [f'for (const {name} &{var} : {expr})', '{']
+    out += ['  namespace status_detail', '  {',
+            '    using Fields = uint32_t[STATUS_FIELD_COUNT];', '',
+            '    // Every field as its 32-bit pattern; differences wrap, so unsigned',
+            '    // counters and signed readings are handled alike',
+            f'    inline void flatten(const {root} &status, Fields &out)', '    {', '      size_t i = 0;']
+    out += walk_status(status, status['root'], 'status.', '      ',
+                       lambda expr, kind: f'out[i++] = static_cast<uint32_t>({expr});', loop)
+    out += ['    }', '',
+            f'    inline void unflatten(const Fields &in, {root} &status)', '    {', '      size_t i = 0;']
+    loop = lambda var, name, expr: [f'for ({name} &{var} : {expr})', '{']
+    out += walk_status(status, status['root'], 'status.', '      ',
+                       lambda expr, kind: f'{expr} = static_cast<{TYPES[kind][1]}>(in[i++]);', loop)
+    out += ['    }', '  }', '']
+    return out
+
+
+def wrap(text, width):
+    lines, line = [], ''
+    for word in text.split():
+        if line and len(line) + 1 + len(word) > width:
+            lines.append(line)
+            line = word
+        else:
+            line = f'{line} {word}' if line else word
+    return lines + [line]
+
+
+def gen_cpp(schema, structs):
+    out = [f'// {BANNER}', '',
+           '#ifndef SHAREDCPP_INCLUDE_PROTOCOL_HPP',
+           '#define SHAREDCPP_INCLUDE_PROTOCOL_HPP', '',
+           '#include <cstddef>', '#include <cstdint>', '',
+           '#include "msg.hpp"', '',
+           '/**',
+           ' * Payload structs of the fixed-size message types (packed,',
+           ' * little-endian), the STATUS telemetry fields, and checks that the',
+           ' * hand-written msg.hpp matches the schema. Edit',
+           ' * shared-cpp/schema/protocol.json and rerun the generator.',
+           ' */',
+           'namespace shr', '{']
+    for struct in schema['structs']:
+        if not struct.get('generate_cpp', True):
+            continue
+        out.append(f"  struct __attribute__((packed)) {struct['name']}")
+        out.append('  {')
+        for field in struct['fields']:
+            out.append(f"    {TYPES[field['type']][1]} {field['name']};{field_comment(field)}")
+        out.append('  };')
+        out.append('')
+
+    out += gen_cpp_status(schema['status'])
+
+    for struct in schema['structs']:
+        name = struct['name']
+        out.append(f"  static_assert(sizeof({name}) == {struct['size']});")
+        for field in struct['fields']:
+            out.append(f"  static_assert(offsetof({name}, {field['name']}) == {field['offset']});")
+    out.append('')
+
+    out.append(f"  static_assert(MessageHeader::CURRENT_VERSION == {schema['version']});")
+    for msg in schema['message_types']:
+        out.append(f"  static_assert(MessageHeader::MSG_TYPE_{msg['name']} == {msg['id']});")
+    for mode in schema['integrity']:
+        out.append(f"  static_assert(static_cast<uint8_t>(Integrity::{mode['name']}) == {mode['id']});")
+        out.append(f"  static_assert(integrityTagSize(Integrity::{mode['name']}) == {mode['tag_size']});")
+    out.append('}')
+    out.append('')
+    out.append('#endif // SHAREDCPP_INCLUDE_PROTOCOL_HPP')
+    return '\n'.join(out) + '\n'
+
+
+def gen_c(schema, structs):
+    out = ['/**',
+           ' * @file protocol.h',
+           ' * @brief Robot link wire format',
+           ' *',
+           f' * {BANNER}',
+           ' * Structs are packed and little-endian, the same layout as shared-cpp.',
+           ' */', '',
+           '#ifndef PROTOCOL_H', '#define PROTOCOL_H', '',
+           '#include <stddef.h>', '#include <stdint.h>', '',
+           '#ifdef __cplusplus', 'extern "C" {', '#endif', '',
+           f"#define PROTO_VERSION              {schema['version']}", '']
+    for msg in schema['message_types']:
+        comment = f"  ///< {msg['comment']}" if 'comment' in msg else ''
+        out.append(f"#define PROTO_MSG_TYPE_{msg['name']:<12}{msg['id']}{comment}")
+    out.append('')
+    width = max(len(mode['name']) for mode in schema['integrity']) + len('_TAG_SIZE') + 1
+    for mode in schema['integrity']:
+        out.append(f"#define PROTO_INTEGRITY_{mode['name']:<{width}}{mode['id']}")
+        out.append(f"#define PROTO_INTEGRITY_{mode['name'] + '_TAG_SIZE':<{width}}{mode['tag_size']}")
+    out.append('')
+
+    for struct in schema['structs']:
+        c_name = f"proto_{snake(struct['name'])}_t"
+        if 'comment' in struct:
+            out.append(f"// {struct['comment']}")
+        out.append('typedef struct __attribute__((packed)) {')
+        for field in struct['fields']:
+            comment = f"  ///< {field['comment']}" if 'comment' in field else ''
+            out.append(f"    {TYPES[field['type']][1]} {field['name']};{comment}")
+        out.append(f'}} {c_name};')
+        out.append(f"_Static_assert(sizeof({c_name}) == {struct['size']}, \"{c_name} size\");")
+        for field in struct['fields']:
+            out.append(f"_Static_assert(offsetof({c_name}, {field['name']}) == {field['offset']}, "
+                       f"\"{c_name}.{field['name']} offset\");")
+        out.append('')
+
+    status = schema['status']
+    out += ['// ' + line for line in wrap(status['comment'], 77)]
+    for bit, flag in enumerate(status['motor_flags']):
+        out.append(f"#define PROTO_MOTOR_FLAG_{flag:<16}(1u << {bit})")
+    out.append('')
+    out.append(f"#define PROTO_STATUS_MOTOR_COUNT   {status['motor_count']}")
+    for kind in status['kinds']:
+        out.append(f"#define PROTO_STATUS_{kind['name']:<14}{kind['id']}")
+    out.append(f"#define PROTO_STATUS_FIELD_COUNT   {status['field_count']}")
+    out.append('')
+    for struct in status['structs']:
+        c_name = f"proto_{snake(struct['name'])}_t"
+        if 'comment' in struct:
+            out.append(f"// {struct['comment']}")
+        out.append('typedef struct {')
+        for field in struct['fields']:
+            comment = f"  ///< {field['comment']}" if 'comment' in field else ''
+            if 'struct' not in field:
+                out.append(f"    {TYPES[field['type']][1]} {field['name']};{comment}")
+            elif 'count' in field:
+                out.append(f"    proto_{snake(field['struct'])}_t {field['name']}[PROTO_STATUS_{field['count'].upper()}];")
+            else:
+                out.append(f"    proto_{snake(field['struct'])}_t {field['name']};")
+        out.append(f'}} {c_name};')
+        out.append('')
+
+    out += ['#ifdef __cplusplus', '}', '#endif', '', '#endif // PROTOCOL_H']
+    return '\n'.join(out) + '\n'
+
+
+TS_FROM_U32 = {
+    'u8': '{} & 0xff',
+    'i8': '{} << 24 >> 24',
+    'u16': '{} & 0xffff',
+    'i16': '{} << 16 >> 16',
+    'u32': '{}',
+    'i32': '{} | 0',
+}
+
+
+def ts_status_literal(status, struct, indent):
+    """
+    Object literal reading struct's fields off next(), in wire order
+    """
+    lines = ['{']
+    for field in struct['fields']:
+        if 'struct' not in field:
+            lines.append(f"{indent}  {field['name']}: {TS_FROM_U32[field['type']].format('next()')},")
+            continue
+        sub = ts_status_literal(status, status['struct_map'][field['struct']], indent + '  ')
+        if 'count' in field:
+            sub[0] = f"Array.from({{ length: STATUS_{field['count'].upper()} }}, () => ({{"
+            sub[-1] = sub[-1][:-1] + '}))'
+            lines.append(f"{indent}  {field['name']}: " + sub[0])
+        else:
+            lines.append(f"{indent}  {field['name']}: " + sub[0])
+        lines += sub[1:-1]
+        lines.append(sub[-1] + ',')
+    lines.append(indent + '}')
+    return lines
+
+
+def gen_ts_status(status):
+    out = ['// ' + line for line in wrap(status['comment'], 77)]
+    out += ['export const MotorFlag = {']
+    for bit, flag in enumerate(status['motor_flags']):
+        out.append(f"  {flag}: 1 << {bit},")
+    out += ['} as const;', '',
+            f"export const STATUS_MOTOR_COUNT = {status['motor_count']};"]
+    for kind in status['kinds']:
+        out.append(f"export const STATUS_{kind['name']} = {kind['id']};")
+    out += [f"export const STATUS_FIELD_COUNT = {status['field_count']};",
+            'export const STATUS_MASK_BYTES = (STATUS_FIELD_COUNT + 7) >> 3;', '',
+            'export enum StatusError {']
+    for i, error in enumerate(status['errors']):
+        out.append(f"  {error['name']} = {i},{field_comment(error)}")
+    out += ['};', '']
+
+    for struct in status['structs']:
+        if 'comment' in struct:
+            out.append(f"// {struct['comment']}")
+        out.append(f"export type {struct['name']} = {{")
+        for field in struct['fields']:
+            kind = 'number'
+            if 'struct' in field:
+                kind = field['struct'] + ('[]' if 'count' in field else '')
+            out.append(f"  {field['name']}: {kind};{field_comment(field)}")
+        out += ['}', '']
+
+    root = status['root']['name']
+    literal = ts_status_literal(status, status['root'], '  ')
+    out += [f'function unflattenStatus(fields: Uint32Array): {root} {{', '  let i = 0;',
+            '  const next = () => fields[i++];', '  return ' + literal[0]] + literal[1:-1] + [literal[-1] + ';', '}', '']
+
+    out += TS_STATUS_DECODER.split('\n')
+    return out
+
+
+# Mirrors StatusDecoder in status.hpp
+TS_STATUS_DECODER = """// Receiver side of the keyframe/delta STATUS encoding
+export class StatusDecoder {
+  private key = new Uint32Array(STATUS_FIELD_COUNT);
+  private keyId = -1;
+
+  /**
+   * @param payload MSG_TYPE_STATUS payload
+   * @returns the status, or null and why not
+   */
+  decode(payload: Uint8Array): { error: StatusError; status: RobotStatus | null } {
+    if (payload.length < 2) {
+      return { error: StatusError.TRUNCATED, status: null };
+    }
+    const kind = payload[0];
+    const keyId = payload[1];
+    const fields = new Uint32Array(STATUS_FIELD_COUNT);
+    let p = 2;
+
+    let error = StatusError.NONE;
+    const fail = (reason: StatusError) => ({ error: reason, status: null });
+
+    // LEB128, at most 5 bytes for 32 bits; -1 with error set on failure
+    const varint = (): number => {
+      let value = 0;
+      for (let i = 0; i < 5; ++i) {
+        if (p >= payload.length) {
+          error = StatusError.TRUNCATED;
+          return -1;
+        }
+        const byte = payload[p++];
+        value = (value | ((byte & 0x7f) << (7 * i))) >>> 0;
+        if (!(byte & 0x80)) {
+          return value;
+        }
+      }
+      error = StatusError.MALFORMED;
+      return -1;
+    };
+
+    if (kind === STATUS_KEYFRAME) {
+      for (let i = 0; i < STATUS_FIELD_COUNT; ++i) {
+        const value = varint();
+        if (value < 0) {
+          return fail(error);
+        }
+        fields[i] = value;
+      }
+    } else if (kind === STATUS_DELTA) {
+      if (keyId !== this.keyId) {
+        return fail(StatusError.NO_KEYFRAME);
+      }
+      if (payload.length - p < STATUS_MASK_BYTES) {
+        return fail(StatusError.TRUNCATED);
+      }
+      const mask = p;
+      p += STATUS_MASK_BYTES;
+      for (let i = 0; i < STATUS_FIELD_COUNT; ++i) {
+        fields[i] = this.key[i];
+        if (!(payload[mask + (i >> 3)] & (1 << (i & 7)))) {
+          continue;
+        }
+        const delta = varint();
+        if (delta < 0) {
+          return fail(error);
+        }
+        // Zigzag back to a signed difference; the store wraps mod 2^32
+        fields[i] = this.key[i] + ((delta >>> 1) ^ -(delta & 1));
+      }
+    } else {
+      return fail(StatusError.BAD_KIND);
+    }
+
+    if (p !== payload.length) {
+      return fail(StatusError.MALFORMED);
+    }
+    if (kind === STATUS_KEYFRAME) {
+      this.key.set(fields);
+      this.keyId = keyId;
+    }
+    return { error: StatusError.NONE, status: unflattenStatus(fields) };
+  }
+}
+"""
+
+
+def gen_ts(schema, structs):
+    out = [f'// {BANNER}', '//',
+           '// Codecs for binary robot frames forwarded over DataChannels. Fields are',
+           '// little-endian at fixed offsets, matching the packed C and C++ structs.', '',
+           f"export const PROTOCOL_VERSION = {schema['version']};", '',
+           'export enum MessageType {']
+    for msg in schema['message_types']:
+        comment = f" // {msg['comment']}" if 'comment' in msg else ''
+        out.append(f"  {msg['name']} = {msg['id']},{comment}")
+    out += ['};', '', 'export enum Integrity {']
+    for mode in schema['integrity']:
+        out.append(f"  {mode['name']} = {mode['id']},")
+    out += ['};', '', 'export const INTEGRITY_TAG_SIZE: Record<Integrity, number> = {']
+    for mode in schema['integrity']:
+        out.append(f"  [Integrity.{mode['name']}]: {mode['tag_size']},")
+    out += ['};', '']
+
+    for struct in schema['structs']:
+        name = struct['name']
+        size_const = f"{snake(name).upper()}_SIZE"
+        if 'comment' in struct:
+            out.append(f"// {struct['comment']}")
+        out.append(f'export type {name} = {{')
+        for field in struct['fields']:
+            out.append(f"  {field['name']}: number;{field_comment(field)}")
+        out += ['}', '', f"export const {size_const} = {struct['size']};", '']
+
+        out.append(f'export function read{name}(view: DataView, offset = 0): {name} {{')
+        out.append('  return {')
+        for field in struct['fields']:
+            kind = TYPES[field['type']]
+            endian = ', true' if kind[0] > 1 else ''
+            out.append(f"    {field['name']}: view.get{kind[2]}(offset + {field['offset']}{endian}),")
+        out += ['  };', '}', '']
+
+        out.append(f'export function write{name}(view: DataView, value: {name}, offset = 0): void {{')
+        for field in struct['fields']:
+            kind = TYPES[field['type']]
+            endian = ', true' if kind[0] > 1 else ''
+            out.append(f"  view.set{kind[2]}(offset + {field['offset']}, value.{field['name']}{endian});")
+        out += ['}', '']
+
+    out += gen_ts_status(schema['status'])
+
+    out.append('// Payload size of each fixed-size message type')
+    out.append('export const PAYLOAD_SIZE: Partial<Record<MessageType, number>> = {')
+    for msg in schema['message_types']:
+        if 'payload' in msg:
+            out.append(f"  [MessageType.{msg['name']}]: {snake(msg['payload']).upper()}_SIZE,")
+    out.append('};')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--check', action='store_true', help='fail if an output is out of date')
+    args = parser.parse_args()
+
+    schema, structs = load_schema()
+    outputs = {
+        CPP_OUT: gen_cpp(schema, structs),
+        C_OUT: gen_c(schema, structs),
+        TS_OUT: gen_ts(schema, structs),
+    }
+
+    stale = []
+    for path, text in outputs.items():
+        current = None
+        if os.path.exists(path):
+            with open(path) as f:
+                current = f.read()
+        if current == text:
+            continue
+        if args.check:
+            stale.append(os.path.relpath(path, ROOT))
+        else:
+            with open(path, 'w') as f:
+                f.write(text)
+            print(f'wrote {os.path.relpath(path, ROOT)}')
+
+    if stale:
+        print('out of date, rerun shared-cpp/schema/gen_protocol.py: ' + ', '.join(stale), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())